@@ -0,0 +1,149 @@
+#include "BenchReport.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+void LatencyRecorder::record(std::chrono::steady_clock::duration elapsed) {
+    samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    sorted = false;
+}
+
+void LatencyRecorder::clear() {
+    samples.clear();
+    sorted = true;
+}
+
+size_t LatencyRecorder::size() const {
+    return samples.size();
+}
+
+double LatencyRecorder::percentileMicros(double p) {
+    if (samples.empty()) return 0;
+    if (!sorted) {
+        std::sort(samples.begin(), samples.end());
+        sorted = true;
+    }
+    // Método nearest-rank: a menor amostra com ao menos p% abaixo ou igual.
+    double rank = std::ceil(p / 100.0 * samples.size());
+    size_t index = (size_t)std::max(rank, 1.0) - 1;
+    index = std::min(index, samples.size() - 1);
+    return samples[index] / 1000.0;
+}
+
+double LatencyRecorder::maxMicros() {
+    return percentileMicros(100);
+}
+
+double BenchResult::opsPerSecond() const {
+    return seconds > 0 ? operations / seconds : 0;
+}
+
+double BenchResult::bytesPerSecond() const {
+    return seconds > 0 ? bytes / seconds : 0;
+}
+
+namespace {
+
+// VmHWM de /proc/self/status em bytes; 0 se não existir.
+size_t readVmHwmBytes() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return (size_t)std::strtoull(line.c_str() + 6, nullptr, 10) * 1024; // Em kB.
+        }
+    }
+#endif
+    return 0;
+}
+
+} // namespace
+
+bool resetPeakRss() {
+#if defined(__linux__)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return clearRefs && readVmHwmBytes() > 0;
+#else
+    return false;
+#endif
+}
+
+size_t peakRssBytes() {
+    size_t hwm = readVmHwmBytes();
+    return hwm > 0 ? hwm : processPeakRssBytes();
+}
+
+size_t processPeakRssBytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss; // Já em bytes no macOS.
+#else
+    return (size_t)usage.ru_maxrss * 1024; // Em KiB no Linux.
+#endif
+#else
+    return 0;
+#endif
+}
+
+void writeJsonString(std::ostream& out, const std::string& value) {
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out << buffer;
+                } else {
+                    out << c;
+                }
+        }
+    }
+    out << '"';
+}
+
+void writeJsonResult(std::ostream& out, BenchResult& result, const std::string& indent) {
+    out << indent << "{\n";
+    out << indent << "  \"name\": ";
+    writeJsonString(out, result.name);
+    out << ",\n";
+    out << indent << "  \"operations\": " << result.operations << ",\n";
+    out << indent << "  \"seconds\": " << result.seconds << ",\n";
+    out << indent << "  \"opsPerSecond\": " << result.opsPerSecond() << ",\n";
+    if (result.bytes > 0) {
+        out << indent << "  \"bytes\": " << result.bytes << ",\n";
+        out << indent << "  \"bytesPerSecond\": " << result.bytesPerSecond() << ",\n";
+    }
+    out << indent << "  \"latencyMicros\": {"
+        << "\"samples\": " << result.latencies.size()
+        << ", \"p50\": " << result.latencies.percentileMicros(50)
+        << ", \"p90\": " << result.latencies.percentileMicros(90)
+        << ", \"p99\": " << result.latencies.percentileMicros(99)
+        << ", \"p999\": " << result.latencies.percentileMicros(99.9)
+        << ", \"max\": " << result.latencies.maxMicros() << "},\n";
+    if (BTreeStats::enabled()) {
+        const BTreeStatsSnapshot& c = result.counters;
+        out << indent << "  \"counters\": {"
+            << "\"nodeVisits\": " << c.nodeVisits
+            << ", \"nodeAllocations\": " << c.nodeAllocations
+            << ", \"postingsDecoded\": " << c.postingsDecoded
+            << ", \"journalRecords\": " << c.journalRecords << "},\n";
+    }
+    out << indent << "  \"peakRssBytes\": " << result.peakRssBytes << "\n";
+    out << indent << "}";
+}
@@ -0,0 +1,65 @@
+#ifndef BENCHREPORT_H
+#define BENCHREPORT_H
+
+#include "../include/structures/BTreeStats.h"
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Guarda a duração de cada operação para calcular percentis no final.
+class LatencyRecorder {
+public:
+    void record(std::chrono::steady_clock::duration elapsed);
+    void clear();
+
+    size_t size() const;
+    // Percentil p (0 a 100) em microssegundos; 0 se não houver amostras.
+    double percentileMicros(double p);
+    double maxMicros();
+
+private:
+    std::vector<int64_t> samples; // Em nanossegundos.
+    bool sorted = true;
+};
+
+// Resultado de um benchmark: operações, tempo total, bytes processados e
+// latências. Vira um objeto do array "results" do JSON.
+struct BenchResult {
+    std::string name;
+    uint64_t operations = 0;
+    double seconds = 0;
+    uint64_t bytes = 0; // 0 quando o benchmark não mede vazão em bytes.
+    LatencyRecorder latencies;
+    BTreeStatsSnapshot counters;
+    size_t peakRssBytes = 0;
+
+    double opsPerSecond() const;
+    double bytesPerSecond() const;
+};
+
+// Pico de memória residente de cada benchmark. O ru_maxrss do getrusage só
+// cresce durante o processo: depois do benchmark mais pesado todos os
+// seguintes repetiriam o mesmo valor. No Linux, resetPeakRss escreve "5" em
+// /proc/self/clear_refs, que volta o pico (VmHWM) para a memória residente
+// atual, e peakRssBytes lê o VmHWM de /proc/self/status. O valor inclui o
+// que já estava residente antes (dados gerados, por exemplo).
+//
+// Retorna false se o reset não for suportado (outros sistemas, /proc sem
+// permissão); nesse caso peakRssBytes é o pico do processo inteiro.
+bool resetPeakRss();
+
+// Pico de memória residente desde o último resetPeakRss (0 se não suportado).
+size_t peakRssBytes();
+
+// Pico de memória residente do processo desde o início (0 se não suportado).
+size_t processPeakRssBytes();
+
+// Escreve uma string JSON, com aspas e escapes.
+void writeJsonString(std::ostream& out, const std::string& value);
+
+// Escreve um resultado como objeto JSON (com a indentação dada).
+void writeJsonResult(std::ostream& out, BenchResult& result, const std::string& indent);
+
+#endif // BENCHREPORT_H
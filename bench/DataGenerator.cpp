@@ -0,0 +1,56 @@
+#include "DataGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+ZipfSampler::ZipfSampler(int n, double skew) : cdf(std::max(n, 1)) {
+    double sum = 0;
+    for (size_t i = 0; i < cdf.size(); ++i) {
+        sum += 1.0 / std::pow((double)(i + 1), skew);
+        cdf[i] = sum;
+    }
+    for (double& value : cdf) {
+        value /= sum;
+    }
+}
+
+int ZipfSampler::operator()(std::mt19937& rng) const {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+    size_t i = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+    return (int)std::min(i, cdf.size() - 1);
+}
+
+DataGenerator::DataGenerator(const DatasetConfig& config) : config(config), rng(config.seed) {}
+
+Dataset DataGenerator::generate() {
+    Dataset data;
+    int players = std::max(config.players, 0);
+    int games = std::max(config.games, 1);
+
+    // Ids únicos embaralhados, para a ordem de inserção não seguir o id.
+    data.playerIds.resize(players);
+    std::iota(data.playerIds.begin(), data.playerIds.end(), 1);
+    std::shuffle(data.playerIds.begin(), data.playerIds.end(), rng);
+
+    ZipfSampler achievementSampler(std::max(config.maxAchievements, 0) + 1, config.skew);
+    data.achievements.reserve(players);
+    for (int playerId : data.playerIds) {
+        data.achievements.emplace_back(achievementSampler(rng), playerId);
+    }
+
+    // Os jogos populares ganham ids aleatórios, não os menores.
+    std::vector<int> gameIds(games);
+    std::iota(gameIds.begin(), gameIds.end(), 1);
+    std::shuffle(gameIds.begin(), gameIds.end(), rng);
+    ZipfSampler gameSampler(games, config.skew);
+    double mean = std::max(config.purchasesPerPlayer, 0.0);
+    std::geometric_distribution<int> ownedGames(1.0 / (mean + 1.0));
+    data.purchases.reserve((size_t)(players * mean));
+    for (int playerId : data.playerIds) {
+        int owned = std::min(ownedGames(rng), games);
+        for (int i = 0; i < owned; ++i) {
+            data.purchases.emplace_back(playerId, gameIds[gameSampler(rng)]);
+        }
+    }
+    return data;
+}
@@ -0,0 +1,53 @@
+#ifndef DATAGENERATOR_H
+#define DATAGENERATOR_H
+
+#include "../include/entities/PurchasedGame.h"
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Parâmetros da massa de dados sintética. Com a mesma semente o gerador
+// produz sempre os mesmos dados, então execuções são comparáveis.
+struct DatasetConfig {
+    int players = 100000;
+    int games = 20000;
+    double purchasesPerPlayer = 20.0; // Média; a distribuição é geométrica.
+    int maxAchievements = 5000;
+    // Expoente da distribuição de Zipf usada para contagens de conquistas e
+    // popularidade dos jogos. 0 é uniforme; perto de 1 parece a Steam, com
+    // a maioria dos jogadores com poucas conquistas e poucos jogos populares.
+    double skew = 0.9;
+    uint32_t seed = 42;
+};
+
+struct Dataset {
+    std::vector<int> playerIds;
+    // Pares (achievementCount, playerId), na ordem em que seriam inseridos.
+    std::vector<std::pair<int, int>> achievements;
+    std::vector<PurchasedGame> purchases;
+};
+
+// Amostra valores em [0, n) com probabilidade proporcional a 1 / (i+1)^s.
+class ZipfSampler {
+public:
+    ZipfSampler(int n, double skew);
+
+    int operator()(std::mt19937& rng) const;
+
+private:
+    std::vector<double> cdf;
+};
+
+class DataGenerator {
+public:
+    explicit DataGenerator(const DatasetConfig& config);
+
+    Dataset generate();
+
+private:
+    DatasetConfig config;
+    std::mt19937 rng;
+};
+
+#endif // DATAGENERATOR_H
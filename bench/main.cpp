@@ -0,0 +1,501 @@
+#include "BenchReport.h"
+#include "DataGenerator.h"
+#include "../include/structures/BTree.h"
+#include "../include/structures/BTreeBuilder.h"
+#include "../include/structures/BTreeJournal.h"
+#include "../include/structures/BTreePersistence.h"
+#include "../include/structures/BTreeStats.h"
+#include "../include/structures/KeySearch.h"
+#include "../include/structures/PagedBTree.h"
+#include "../include/structures/Parallel.h"
+#include "../include/structures/PurchaseIndex.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Benchmarks da biblioteca core.
+//
+// Uso: bench [--players N] [--games N] [--purchases-per-player X]
+//            [--max-achievements N] [--skew S] [--seed N] [--degree T]
+//            [--threads N] [--repeat N] [--queries N] [--range-width N]
+//            [--workdir DIR] [--output ARQUIVO] [--only TRECHO]
+//
+// Cada benchmark roda --repeat vezes sobre os mesmos dados e o resultado
+// soma todas as rodadas. A saída é um JSON (no stdout ou em --output) com a
+// configuração, vazão, percentis de latência, bytes/s e pico de memória.
+//
+// O "peakRssBytes" de cada resultado é o pico de memória residente durante
+// aquele benchmark (no Linux, via /proc/self/clear_refs e VmHWM; ver
+// BenchReport.h). Onde isso não é suportado, "peakRssPerBenchmark" sai
+// false e o valor é o pico do processo até ali. O "peakRssBytes" do fim do
+// JSON é sempre o pico do processo inteiro.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchOptions {
+    DatasetConfig data;
+    int minDegree = 32;
+    int threads = 0; // 0 usa todos os núcleos.
+    int repeat = 3;
+    int queries = 100000;
+    int rangeWidth = 10;
+    std::string workDir;
+    std::string output;
+    std::string only; // Roda só benchmarks cujo nome contém este trecho.
+};
+
+// Impede que o compilador descarte o resultado de uma consulta.
+volatile size_t sink = 0;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+uint64_t fileSize(const std::string& filename) {
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(filename, error);
+    return error ? 0 : (uint64_t)size;
+}
+
+void removeFile(const std::string& filename) {
+    std::error_code error;
+    std::filesystem::remove(filename, error);
+    std::filesystem::remove(BTreeJournal::pathFor(filename), error);
+}
+
+bool parseArguments(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Erro: Falta o valor de " << arg << std::endl;
+            return false;
+        }
+        const char* value = argv[++i];
+        if (arg == "--players") options.data.players = std::atoi(value);
+        else if (arg == "--games") options.data.games = std::atoi(value);
+        else if (arg == "--purchases-per-player") options.data.purchasesPerPlayer = std::atof(value);
+        else if (arg == "--max-achievements") options.data.maxAchievements = std::atoi(value);
+        else if (arg == "--skew") options.data.skew = std::atof(value);
+        else if (arg == "--seed") options.data.seed = (uint32_t)std::strtoul(value, nullptr, 10);
+        else if (arg == "--degree") options.minDegree = std::atoi(value);
+        else if (arg == "--threads") options.threads = std::atoi(value);
+        else if (arg == "--repeat") options.repeat = std::atoi(value);
+        else if (arg == "--queries") options.queries = std::atoi(value);
+        else if (arg == "--range-width") options.rangeWidth = std::atoi(value);
+        else if (arg == "--workdir") options.workDir = value;
+        else if (arg == "--output") options.output = value;
+        else if (arg == "--only") options.only = value;
+        else {
+            std::cerr << "Erro: Opcao desconhecida: " << arg << std::endl;
+            return false;
+        }
+    }
+    if (options.minDegree < 2 || options.repeat < 1 || options.queries < 0 || options.data.players < 0) {
+        std::cerr << "Erro: Valores invalidos para --degree, --repeat, --queries ou --players." << std::endl;
+        return false;
+    }
+    if (options.workDir.empty()) {
+        options.workDir = std::filesystem::temp_directory_path().string();
+    }
+    return true;
+}
+
+class BenchSuite {
+public:
+    BenchSuite(const BenchOptions& options, const Dataset& data)
+        : options(options), data(data), rng(options.data.seed) {}
+
+    // Roda um benchmark. "body" executa uma rodada e soma operações,
+    // bytes, tempo e latências em result.
+    void run(const std::string& name, const std::function<void(BenchResult&)>& body) {
+        if (!options.only.empty() && name.find(options.only) == std::string::npos) return;
+        std::cerr << "Rodando " << name << "..." << std::endl;
+        BenchResult result;
+        result.name = name;
+        BTreeStats::global().reset();
+        peakRssPerBenchmark = resetPeakRss() && peakRssPerBenchmark;
+        for (int r = 0; r < options.repeat; ++r) {
+            body(result);
+        }
+        result.counters = BTreeStats::global().read();
+        result.peakRssBytes = peakRssBytes();
+        results.push_back(std::move(result));
+    }
+
+    void runAll() {
+        runTreeBenchmarks();
+        runPersistenceBenchmarks();
+        runPagedBenchmarks();
+        runPurchaseIndexBenchmarks();
+        runMacroBenchmark();
+    }
+
+    void writeJson(std::ostream& out) {
+        const DatasetConfig& d = options.data;
+        out << "{\n";
+        out << "  \"config\": {"
+            << "\"players\": " << d.players
+            << ", \"games\": " << d.games
+            << ", \"purchasesPerPlayer\": " << d.purchasesPerPlayer
+            << ", \"maxAchievements\": " << d.maxAchievements
+            << ", \"skew\": " << d.skew
+            << ", \"seed\": " << d.seed
+            << ", \"minDegree\": " << options.minDegree
+            << ", \"threads\": " << resolveThreadCount(options.threads)
+            << ", \"repeat\": " << options.repeat
+            << ", \"queries\": " << options.queries
+            << ", \"rangeWidth\": " << options.rangeWidth << "},\n";
+        out << "  \"dataset\": {"
+            << "\"achievementPairs\": " << data.achievements.size()
+            << ", \"purchases\": " << data.purchases.size() << "},\n";
+        out << "  \"environment\": {\"keySearch\": ";
+        writeJsonString(out, KeySearch::implementationName());
+        out << ", \"statsEnabled\": " << (BTreeStats::enabled() ? "true" : "false")
+            << ", \"peakRssPerBenchmark\": " << (peakRssPerBenchmark ? "true" : "false") << "},\n";
+        out << "  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            writeJsonResult(out, results[i], "    ");
+            out << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        out << "  ],\n";
+        out << "  \"peakRssBytes\": " << processPeakRssBytes() << "\n";
+        out << "}" << std::endl;
+    }
+
+private:
+    const BenchOptions& options;
+    const Dataset& data;
+    std::mt19937 rng;
+    std::vector<BenchResult> results;
+    bool peakRssPerBenchmark = true;
+
+    std::string pathFor(const std::string& name) const {
+        return (std::filesystem::path(options.workDir) / ("bench_" + name)).string();
+    }
+
+    // Árvore com todos os pares, montada por inserções como no programa.
+    BTree* insertAll() const {
+        BTree* tree = new BTree(options.minDegree);
+        for (const auto& pair : data.achievements) {
+            tree->insert(pair.first, pair.second);
+        }
+        return tree;
+    }
+
+    // Contagens a consultar: sorteadas dos próprios dados, então seguem a
+    // mesma distribuição (consultas frequentes nas contagens comuns).
+    std::vector<int> queryCounts() {
+        std::vector<int> counts(options.queries, 0);
+        if (data.achievements.empty()) return counts;
+        std::uniform_int_distribution<size_t> pick(0, data.achievements.size() - 1);
+        for (int& count : counts) {
+            count = data.achievements[pick(rng)].first;
+        }
+        return counts;
+    }
+
+    template <typename Query>
+    void timeQueries(BenchResult& result, const std::vector<int>& counts, Query query) {
+        Clock::time_point start = Clock::now();
+        for (int count : counts) {
+            Clock::time_point begin = Clock::now();
+            sink = sink + query(count);
+            result.latencies.record(Clock::now() - begin);
+        }
+        result.seconds += secondsSince(start);
+        result.operations += counts.size();
+    }
+
+    void runTreeBenchmarks() {
+        run("btree.insert", [&](BenchResult& result) {
+            BTree tree(options.minDegree);
+            Clock::time_point start = Clock::now();
+            for (const auto& pair : data.achievements) {
+                Clock::time_point begin = Clock::now();
+                tree.insert(pair.first, pair.second);
+                result.latencies.record(Clock::now() - begin);
+            }
+            result.seconds += secondsSince(start);
+            result.operations += data.achievements.size();
+        });
+
+        run("btree.bulkLoad", [&](BenchResult& result) {
+            std::vector<std::pair<int, int>> sorted = data.achievements;
+            std::sort(sorted.begin(), sorted.end());
+            Clock::time_point start = Clock::now();
+            BTreeBuilder builder(options.minDegree);
+            for (const auto& pair : sorted) {
+                builder.add(pair.first, pair.second);
+            }
+            BTree* tree = BTreePersistence::buildTree(builder);
+            Clock::duration elapsed = Clock::now() - start;
+            result.latencies.record(elapsed);
+            result.seconds += std::chrono::duration<double>(elapsed).count();
+            result.operations += sorted.size();
+            delete tree;
+        });
+
+        BTree* tree = insertAll();
+        std::vector<int> counts = queryCounts();
+        run("btree.search", [&](BenchResult& result) {
+            timeQueries(result, counts, [&](int count) { return tree->search(count).size(); });
+        });
+        run("btree.searchRange", [&](BenchResult& result) {
+            timeQueries(result, counts, [&](int count) {
+                return tree->searchRange(count, count + options.rangeWidth).size();
+            });
+        });
+        delete tree;
+    }
+
+    void runPersistenceBenchmarks() {
+        BTree* tree = insertAll();
+        struct Variant {
+            const char* name;
+            bool compress;
+            int threads;
+        };
+        const Variant variants[] = {
+            {"plain", false, 1},
+            {"compressed", true, 1},
+            {"parallel", false, options.threads},
+            {"compressedParallel", true, options.threads},
+        };
+        for (const Variant& variant : variants) {
+            std::string file = pathFor(std::string("tree_") + variant.name + ".dat");
+            BTreeSaveOptions saveOptions;
+            saveOptions.compressPostings = variant.compress;
+            saveOptions.threadCount = variant.threads;
+
+            run(std::string("persistence.save.") + variant.name, [&](BenchResult& result) {
+                Clock::time_point start = Clock::now();
+                BTreePersistence::saveToFile(tree, file, saveOptions);
+                Clock::duration elapsed = Clock::now() - start;
+                result.latencies.record(elapsed);
+                result.seconds += std::chrono::duration<double>(elapsed).count();
+                result.operations += 1;
+                result.bytes += fileSize(file);
+            });
+
+            // O load precisa do arquivo mesmo quando o save foi filtrado.
+            if (fileSize(file) == 0) {
+                BTreePersistence::saveToFile(tree, file, saveOptions);
+            }
+            run(std::string("persistence.load.") + variant.name, [&](BenchResult& result) {
+                Clock::time_point start = Clock::now();
+                BTree* loaded = BTreePersistence::loadFromFile(file, options.threads);
+                Clock::duration elapsed = Clock::now() - start;
+                result.latencies.record(elapsed);
+                result.seconds += std::chrono::duration<double>(elapsed).count();
+                result.operations += 1;
+                result.bytes += fileSize(file);
+                delete loaded;
+            });
+            // Destruição da árvore carregada: um nó e uma lista por chave
+            // liberados um a um, o custo que uma arena eliminaria.
+            run(std::string("persistence.teardown.") + variant.name, [&](BenchResult& result) {
+                BTree* loaded = BTreePersistence::loadFromFile(file, options.threads);
+                Clock::time_point start = Clock::now();
+                delete loaded;
+                Clock::duration elapsed = Clock::now() - start;
+                result.latencies.record(elapsed);
+                result.seconds += std::chrono::duration<double>(elapsed).count();
+                result.operations += 1;
+            });
+            removeFile(file);
+        }
+        delete tree;
+    }
+
+    void runPagedBenchmarks() {
+        std::string file = pathFor("tree_paged.dat");
+        BTree* tree = insertAll();
+        run("paged.save", [&](BenchResult& result) {
+            Clock::time_point start = Clock::now();
+            BTreePersistence::savePagedToFile(tree, file);
+            Clock::duration elapsed = Clock::now() - start;
+            result.latencies.record(elapsed);
+            result.seconds += std::chrono::duration<double>(elapsed).count();
+            result.operations += 1;
+            result.bytes += fileSize(file);
+        });
+        if (fileSize(file) == 0) {
+            BTreePersistence::savePagedToFile(tree, file);
+        }
+        delete tree;
+
+        PagedBTree* paged = BTreePersistence::openPaged(file);
+        if (paged) {
+            std::vector<int> counts = queryCounts();
+            run("paged.search", [&](BenchResult& result) {
+                timeQueries(result, counts, [&](int count) { return paged->search(count).size(); });
+            });
+            run("paged.searchRange", [&](BenchResult& result) {
+                timeQueries(result, counts, [&](int count) {
+                    return paged->searchRange(count, count + options.rangeWidth).size();
+                });
+            });
+            delete paged;
+        }
+        removeFile(file);
+    }
+
+    void runPurchaseIndexBenchmarks() {
+        std::string file = pathFor("purchases.idx");
+        run("purchaseIndex.build", [&](BenchResult& result) {
+            PurchaseIndex index;
+            Clock::time_point start = Clock::now();
+            index.build(data.purchases, options.threads);
+            Clock::duration elapsed = Clock::now() - start;
+            result.latencies.record(elapsed);
+            result.seconds += std::chrono::duration<double>(elapsed).count();
+            result.operations += data.purchases.size();
+        });
+
+        PurchaseIndex built;
+        built.build(data.purchases, options.threads);
+        built.saveToFile(file);
+        run("purchaseIndex.open", [&](BenchResult& result) {
+            PurchaseIndex index;
+            Clock::time_point start = Clock::now();
+            index.openFile(file);
+            Clock::duration elapsed = Clock::now() - start;
+            result.latencies.record(elapsed);
+            result.seconds += std::chrono::duration<double>(elapsed).count();
+            result.operations += 1;
+        });
+
+        if (!data.playerIds.empty()) {
+            std::uniform_int_distribution<size_t> pick(0, data.playerIds.size() - 1);
+            std::vector<std::pair<int, int>> pairs(options.queries);
+            for (auto& pair : pairs) {
+                pair = {data.playerIds[pick(rng)], data.playerIds[pick(rng)]};
+            }
+            run("purchaseIndex.sharedGames", [&](BenchResult& result) {
+                Clock::time_point start = Clock::now();
+                for (const auto& pair : pairs) {
+                    Clock::time_point begin = Clock::now();
+                    sink = sink + built.sharedGames(pair.first, pair.second).size();
+                    result.latencies.record(Clock::now() - begin);
+                }
+                result.seconds += secondsSince(start);
+                result.operations += pairs.size();
+            });
+        }
+        removeFile(file);
+    }
+
+    // Fluxo completo do programa, em dois resultados para que cada
+    // histograma tenha um só tipo de operação:
+    //   macro.ingestCheckpoint: inserções registradas no log com checkpoints
+    //     periódicos. Latências das inserções; os bytes são tudo o que foi
+    //     gravado: o log até cada checkpoint mais cada snapshot.
+    //   macro.reloadQuery: recarga do snapshot (com o resto do log) seguida
+    //     das consultas. Latências só das consultas; o tempo total inclui a
+    //     recarga e os bytes são os do snapshot lido.
+    void runMacroBenchmark() {
+        std::string file = pathFor("macro.dat");
+        std::vector<int> counts = queryCounts();
+        run("macro.ingestCheckpoint", [&](BenchResult& result) {
+            Clock::time_point start = Clock::now();
+            ingestWithCheckpoints(file, result);
+            result.seconds += secondsSince(start);
+            result.operations += data.achievements.size();
+        });
+
+        // A recarga precisa do arquivo mesmo quando a ingestão foi filtrada.
+        if (fileSize(file) == 0) {
+            BenchResult untimed;
+            ingestWithCheckpoints(file, untimed);
+        }
+        run("macro.reloadQuery", [&](BenchResult& result) {
+            Clock::time_point start = Clock::now();
+            BTree* tree = BTreePersistence::loadFromFile(file, options.threads);
+            result.bytes += fileSize(file);
+            if (tree) {
+                for (int count : counts) {
+                    Clock::time_point begin = Clock::now();
+                    sink = sink + tree->searchRange(count, count + options.rangeWidth).size();
+                    result.latencies.record(Clock::now() - begin);
+                }
+                delete tree;
+            }
+            result.seconds += secondsSince(start);
+            result.operations += counts.size();
+        });
+        removeFile(file);
+    }
+
+    // Insere todos os pares numa árvore nova com log em "file", fazendo
+    // checkpoint sempre que o log pede e um último no fim.
+    void ingestWithCheckpoints(const std::string& file, BenchResult& result) {
+        removeFile(file);
+        BTree* tree = new BTree(options.minDegree);
+        BTreeJournal journal;
+        journal.open(file, options.minDegree);
+        std::string log = BTreeJournal::pathFor(file);
+        auto checkpoint = [&]() {
+            journal.flush();
+            result.bytes += fileSize(log);
+            BTreePersistence::checkpoint(tree, file, journal);
+            result.bytes += fileSize(file);
+        };
+        size_t sinceFlush = 0;
+        for (const auto& pair : data.achievements) {
+            Clock::time_point begin = Clock::now();
+            tree->insert(pair.first, pair.second);
+            journal.logInsert(pair.first, pair.second);
+            // Grupos de registros por flush, como um commit em lote.
+            if (++sinceFlush == 256) {
+                journal.flush();
+                sinceFlush = 0;
+            }
+            if (journal.shouldCheckpoint()) {
+                checkpoint();
+            }
+            result.latencies.record(Clock::now() - begin);
+        }
+        checkpoint();
+        journal.close();
+        delete tree;
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        return 1;
+    }
+
+    Clock::time_point start = Clock::now();
+    DataGenerator generator(options.data);
+    Dataset data = generator.generate();
+    std::cerr << "Dados gerados em " << secondsSince(start) << "s: " << data.achievements.size()
+              << " pares, " << data.purchases.size() << " compras." << std::endl;
+
+    BenchSuite suite(options, data);
+    suite.runAll();
+
+    if (options.output.empty()) {
+        suite.writeJson(std::cout);
+    } else {
+        std::ofstream out(options.output);
+        if (!out) {
+            std::cerr << "Erro: Nao foi possivel abrir " << options.output << std::endl;
+            return 1;
+        }
+        suite.writeJson(out);
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Mapeia um arquivo inteiro em memória apenas para leitura.
+// Em sistemas POSIX usa mmap, de modo que as páginas só são lidas do disco
+// quando acessadas. Em outras plataformas o arquivo é lido para um buffer.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Abre e mapeia o arquivo. Retorna false se não existir ou estiver vazio.
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const;
+    const char* data() const;
+    size_t size() const;
+
+private:
+    const char* mappedData;
+    size_t mappedSize;
+    std::vector<char> fallbackBuffer; // Usado apenas quando não há mmap.
+};
+
+#endif // MAPPEDFILE_H
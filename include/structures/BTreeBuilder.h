@@ -0,0 +1,59 @@
+#ifndef BTREEBUILDER_H
+#define BTREEBUILDER_H
+
+#include "BTreeNode.h"
+#include <cstddef>
+#include <vector>
+
+// Construção em lote (bottom-up) de uma Árvore B a partir de pares
+// (achievementCount, playerId) já ordenados por achievementCount.
+//
+// Em vez de uma inserção por par, as chaves são agrupadas e as folhas são
+// preenchidas até o fator de ocupação configurado; as chaves separadoras
+// sobem para formar os níveis internos até restar uma única raiz.
+// O layout resultante é materializado por BTreePersistence::buildTree ou
+// escrito direto em arquivo por BTreePersistence::saveBuiltToFile.
+class BTreeBuilder {
+public:
+    // fillFactor: fração de 2t-1 chaves usada por nó (limitado a [t-1, 2t-1]).
+    BTreeBuilder(int minDegree, double fillFactor = 1.0);
+
+    // Adiciona um par. Os pares devem chegar em ordem não decrescente de
+    // achievementCount; chaves repetidas são agrupadas num único playerIds.
+    // Retorna false (e ignora o par) se a ordem for violada.
+    bool add(int achievementCount, int playerId);
+
+    // Calcula os níveis da árvore. Depois disso add() não é mais aceito.
+    void build();
+
+    int getMinDegree() const;
+    size_t getKeyCount() const;
+    size_t getNodeCount() const;
+    bool isBuilt() const;
+
+    // Descarta chaves e layout para reutilizar o builder.
+    void clear();
+
+private:
+    friend class BTreePersistence;
+
+    // Um nível da árvore. "sequence" são os índices (em keys) das chaves que
+    // chegaram a este nível; cada nó ocupa um trecho contíguo dela e a
+    // posição entre dois nós vizinhos é o separador que sobe para o pai.
+    struct Level {
+        std::vector<size_t> sequence;
+        std::vector<size_t> nodeStart;    // Início do nó em sequence.
+        std::vector<int> nodeKeyCount;
+        std::vector<size_t> firstChild;   // Primeiro filho no nível abaixo.
+    };
+
+    void splitLevel(Level& level, std::vector<size_t>& separators) const;
+
+    int minDegree;
+    int nodeCapacity;
+    bool built;
+    std::vector<AchievementKey> keys;
+    std::vector<Level> levels; // levels[0] são as folhas; o último é a raiz.
+};
+
+#endif // BTREEBUILDER_H
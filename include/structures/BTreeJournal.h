@@ -0,0 +1,104 @@
+#ifndef BTREEJOURNAL_H
+#define BTREEJOURNAL_H
+
+#include "BTree.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Log de operações (write-ahead log) da Árvore B.
+//
+// Cada insert/remove vira um registro de tamanho fixo anexado ao arquivo
+// "<snapshot>.wal" (após um cabeçalho com o grau mínimo da árvore), então
+// salvar custa O(alterações) em vez de regravar a árvore inteira. Todo
+// registro tem um número de sequência (LSN) e um checksum; um registro
+// incompleto no fim do arquivo (processo morto no meio da escrita) é
+// descartado na abertura.
+//
+// O snapshot gravado por BTreePersistence::checkpoint guarda o último LSN
+// que já contém, e BTreePersistence::loadFromFile reaplica apenas os
+// registros posteriores a ele.
+class BTreeJournal {
+public:
+    enum Operation : uint8_t {
+        OP_INSERT = 1,
+        OP_REMOVE = 2
+    };
+
+    // checkpointInterval: quantidade de registros após a qual
+    // shouldCheckpoint() sugere compactar o log num novo snapshot.
+    explicit BTreeJournal(size_t checkpointInterval = 100000);
+    ~BTreeJournal();
+
+    BTreeJournal(const BTreeJournal&) = delete;
+    BTreeJournal& operator=(const BTreeJournal&) = delete;
+
+    // Caminho do log associado a um arquivo de snapshot.
+    static std::string pathFor(const std::string& snapshotFile);
+
+    // Abre (ou cria) o log do snapshot, descartando um final corrompido.
+    // O grau mínimo fica no cabeçalho do log para que a árvore possa ser
+    // recriada mesmo antes do primeiro checkpoint.
+    bool open(const std::string& snapshotFile, int minDegree);
+    void close();
+    bool isOpen() const;
+
+    // Registram a operação. O registro só chega ao disco em flush().
+    void logInsert(int achievementCount, int playerId);
+    void logRemove(int achievementCount, int playerId);
+
+    // Grava os registros pendentes no arquivo e espera chegarem ao disco
+    // (fsync). Só depois disso uma operação pode ser considerada salva.
+    bool flush();
+
+    // Esvazia o log depois que um snapshot passou a cobrir todos os registros.
+    bool truncate();
+
+    bool shouldCheckpoint() const;
+    uint64_t getLastLsn() const;
+    size_t getRecordCount() const; // Registros desde o último checkpoint.
+
+    // Aplica na árvore os registros com LSN maior que afterLsn.
+    // Retorna quantos registros foram aplicados.
+    static size_t replay(const std::string& logFile, BTree* tree, uint64_t afterLsn);
+
+    // Grau mínimo gravado no cabeçalho do log, ou 0 se não houver log válido.
+    static int readMinDegree(const std::string& logFile);
+
+private:
+    static constexpr uint32_t LOG_MAGIC = 0x4C415742; // "BWAL"
+
+    struct LogHeader {
+        uint32_t magic;
+        int32_t minDegree;
+    };
+
+#pragma pack(push, 1)
+    struct Record {
+        uint64_t lsn;
+        uint8_t op;
+        int32_t achievementCount;
+        int32_t playerId;
+        uint32_t checksum;
+    };
+#pragma pack(pop)
+
+    static uint32_t checksumOf(const Record& record);
+    // Lê registros válidos em sequência; retorna o tamanho em bytes do trecho válido.
+    static uint64_t scan(const std::string& logFile, std::vector<Record>* records, uint64_t& lastLsn);
+
+    void append(uint8_t op, int achievementCount, int playerId);
+    bool writeHeader();
+
+    std::string logPath;
+    std::FILE* out;
+    std::vector<Record> pending;
+    int minDegree;
+    uint64_t lastLsn;
+    size_t recordCount;
+    size_t checkpointInterval;
+};
+
+#endif // BTREEJOURNAL_H
@@ -2,22 +2,174 @@
 #define BTREEPERSISTENCE_H
 
 #include "BTree.h"
+#include "BTreeBuilder.h"
+#include "BTreeJournal.h"
+#include "PagedBTree.h"
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <iosfwd>
+#include <shared_mutex>
 #include <string>
+#include <vector>
+
+// Opções de gravação. Com os valores padrão o arquivo sai no formato
+// original (apenas o grau mínimo seguido dos nós em pré-ordem).
+struct BTreeSaveOptions {
+    // Grava as listas de jogadores como PostingList (delta + varint).
+    bool compressPostings = false;
+
+    // Threads usadas para codificar subárvores em paralelo. Com 1 o arquivo
+    // é gravado em sequência; com outro valor ganha uma tabela de offsets
+    // das subárvores (0 usa todos os núcleos).
+    int threadCount = 1;
+};
+
+// Resultado de um snapshot em segundo plano (ver saveSnapshotAsync).
+struct SnapshotResult {
+    bool success = false;
+    size_t bytesWritten = 0;
+    double captureMillis = 0; // Tempo com o lock compartilhado da árvore.
+    double writeMillis = 0;   // Codificação e gravação em disco, já sem lock.
+    double totalMillis = 0;   // Da chamada até o arquivo estar no lugar.
+};
 
 class BTreePersistence {
 public:
-    // Salva a Árvore B em um arquivo.
-    static void saveToFile(BTree* tree, const std::string& filename);
+    // Arquivos com opções não padrão começam com este número mágico (negativo,
+    // logo nunca confundido com o grau mínimo do formato original), seguido
+    // da versão, das flags e do grau mínimo.
+    static constexpr int FORMAT_MAGIC = -0x42545245;
+    static constexpr int FORMAT_VERSION = 4;
+    static constexpr int FLAG_COMPRESSED_POSTINGS = 1;
+    static constexpr int FLAG_CHECKPOINT_LSN = 2; // Um uint64 após o grau.
+    static constexpr int FLAG_SUBTREE_TABLE = 4;  // Subárvores com tabela de tamanhos (versão 4).
+    // Flags que este código sabe ler; qualquer outra faz o arquivo ser recusado.
+    static constexpr int KNOWN_FLAGS = FLAG_COMPRESSED_POSTINGS | FLAG_CHECKPOINT_LSN | FLAG_SUBTREE_TABLE;
+
+    // Graus mínimos até este valor são aceitos na carga sem conferência extra.
+    static constexpr int MAX_UNCHECKED_DEGREE = 4096;
+
+    // Confere um grau mínimo lido de um arquivo antes de criar nós: cada nó
+    // reserva 2t-1 chaves mesmo com poucas em uso, então um grau corrompido
+    // (ex.: 1 << 29) viraria uma alocação de gigabytes. Graus abaixo de 2
+    // são recusados; acima de MAX_UNCHECKED_DEGREE, só com ao menos 2t-1
+    // bytes depois do cabeçalho, o mínimo que um nó cheio ocupa no arquivo.
+    static bool isPlausibleDegree(int minDegree, uint64_t bytesLeft);
+
+    // Salva a Árvore B em um arquivo. A gravação é feita num arquivo
+    // temporário renomeado no final, então uma falha no meio nunca deixa
+    // o arquivo anterior truncado. Se o arquivo tiver um log ao lado, a
+    // gravação é recusada: sem o LSN o log inteiro seria reaplicado por
+    // cima do snapshot na próxima carga (use checkpoint).
+    static void saveToFile(BTree* tree, const std::string& filename,
+                           const BTreeSaveOptions& options = BTreeSaveOptions());
     
     // Carrega uma Árvore B de um arquivo.
     // A assinatura foi corrigida para não receber mais o grau 't',
     // pois ele é lido de dentro do arquivo.
-    static BTree* loadFromFile(const std::string& filename);
+    // Se existir um log (BTreeJournal) ao lado do arquivo, as operações
+    // posteriores ao snapshot são reaplicadas. Arquivos gravados com
+    // threadCount != 1 têm as subárvores decodificadas em paralelo por
+    // threadCount threads (0 usa todos os núcleos).
+    static BTree* loadFromFile(const std::string& filename, int threadCount = 0);
+
+    // Compacta o log num novo snapshot: grava a árvore inteira (de forma
+    // atômica) junto com o último LSN do log e então esvazia o log.
+    // Com um log ativo use esta função em vez de saveToFile, que não grava
+    // o LSN e por isso é recusada.
+    static bool checkpoint(BTree* tree, const std::string& filename, BTreeJournal& journal,
+                           const BTreeSaveOptions& options = BTreeSaveOptions());
+
+    // Salva um snapshot consistente da árvore numa thread separada.
+    // O chamador retorna imediatamente. A thread copia os nós da árvore,
+    // sem codificar nada, segurando treeMutex em modo compartilhado (buscas
+    // continuam; inserções esperam só essa cópia) e depois codifica e grava
+    // a cópia sem lock nenhum. A cópia ocupa tanta memória quanto a árvore
+    // até o fim da gravação. Quem altera a árvore deve usar treeMutex em
+    // modo exclusivo. O future precisa ser mantido: destruí-lo espera o fim.
+    // Se o arquivo tiver um log ao lado, o snapshot é recusado: sem o LSN
+    // o log inteiro seria reaplicado por cima dele na próxima carga.
+    static std::future<SnapshotResult> saveSnapshotAsync(BTree* tree, const std::string& filename,
+                                                         std::shared_mutex& treeMutex,
+                                                         const BTreeSaveOptions& options = BTreeSaveOptions());
+
+    // Mesmo snapshot para uma árvore com log: o último LSN do journal é lido
+    // sob o mesmo lock da cópia e gravado no arquivo, então a carga só
+    // reaplica os registros posteriores. Quem altera a árvore deve registrar
+    // a operação no journal dentro do mesmo lock exclusivo. O log não é
+    // esvaziado; para compactá-lo use checkpoint().
+    static std::future<SnapshotResult> saveSnapshotAsync(BTree* tree, const std::string& filename,
+                                                         std::shared_mutex& treeMutex, BTreeJournal& journal,
+                                                         const BTreeSaveOptions& options = BTreeSaveOptions());
+
+    // LSN gravado no snapshot por checkpoint(), ou 0 se não houver.
+    static uint64_t readCheckpointLsn(const std::string& filename);
+
+    // Salva a Árvore B no formato paginado (ver PagedBTree.h).
+    static bool savePagedToFile(BTree* tree, const std::string& filename);
+
+    // Abre um arquivo paginado para consultas sem reconstruir a árvore.
+    // Retorna nullptr se o arquivo não existir ou for inválido.
+    static PagedBTree* openPaged(const std::string& filename);
+
+    // Materializa a árvore montada por um BTreeBuilder sem nenhuma inserção.
+    // As listas de jogadores são movidas, então o builder fica vazio.
+    static BTree* buildTree(BTreeBuilder& builder);
+
+    // Escreve o layout de um BTreeBuilder direto no formato de saveToFile,
+    // sem criar os nós da árvore em memória. Como saveToFile, é recusada se
+    // o arquivo tiver um log ao lado.
+    static bool saveBuiltToFile(BTreeBuilder& builder, const std::string& filename,
+                                const BTreeSaveOptions& options = BTreeSaveOptions());
 
 private:
     // Funções auxiliares recursivas para salvar e carregar os nós.
-    static void saveNode(std::ofstream& out, BTreeNode* node);
-    static BTreeNode* loadNode(std::ifstream& in, int minDegree);
+    static void saveNode(std::ostream& out, BTreeNode* node, int flags);
+    // "scratch" é reaproveitado entre as chaves para não alocar um buffer
+    // por lista de jogadores comprimida.
+    static BTreeNode* loadNode(std::istream& in, int minDegree, int flags, std::vector<uint8_t>& scratch);
+    static void saveKey(std::ostream& out, const AchievementKey& key, int flags);
+    static void loadKey(std::istream& in, AchievementKey& key, int flags, std::vector<uint8_t>& scratch);
+    static void saveBuiltNode(std::ostream& out, const BTreeBuilder& builder, size_t level, size_t node, int flags);
+
+    // Cabeçalho: grava/lê o grau mínimo e, se houver flags, o número mágico.
+    static int flagsFor(const BTreeSaveOptions& options);
+    static void writeHeader(std::ostream& out, int minDegree, int flags, uint64_t lsn);
+    static bool readHeader(std::istream& in, int& minDegree, int& flags, uint64_t& lsn);
+
+    // Implementação das duas versões de saveSnapshotAsync (journal pode ser nulo).
+    static std::future<SnapshotResult> startSnapshot(BTree* tree, const std::string& filename,
+                                                     std::shared_mutex& treeMutex, BTreeJournal* journal,
+                                                     const BTreeSaveOptions& options);
+
+    // true (e uma mensagem de erro) se um snapshot sem FLAG_CHECKPOINT_LSN
+    // fosse gravado sobre um arquivo com log.
+    static bool hasUncoveredLog(const std::string& filename, int flags);
+
+    // Cópia profunda de uma subárvore (nós e listas de jogadores).
+    static BTreeNode* cloneNode(BTreeNode* node, int minDegree);
+
+    // Grava o snapshot em "<filename>.tmp" e o renomeia sobre o destino.
+    static bool writeSnapshot(BTree* tree, const std::string& filename, int flags, uint64_t lsn,
+                              int threadCount);
+
+    // Árvore completa (cabeçalho + nós), em sequência ou com a tabela de
+    // subárvores conforme FLAG_SUBTREE_TABLE. Com a tabela, "out" precisa
+    // aceitar seekp (os tamanhos são preenchidos no fim) e a memória extra
+    // é a de um lote de subárvores codificadas, uma por thread.
+    static void saveTree(std::ostream& out, BTree* tree, int flags, uint64_t lsn, int threadCount);
+    // Se "base" não for nulo, "in" lê exatamente a memória a partir de base
+    // (arquivo mapeado) e as subárvores são decodificadas no lugar, sem cópia.
+    // Retorna false se o arquivo estiver truncado ou corrompido.
+    static bool loadTree(std::istream& in, int minDegree, int flags, int threadCount,
+                         const char* base, BTreeNode*& root);
+
+    // Níveis acima do ponto de corte; os nós na profundidade splitDepth
+    // ficam nas subárvores independentes e seus ponteiros em "slots".
+    static void saveTopNode(std::ostream& out, BTreeNode* node, int depth, int splitDepth, int flags);
+    static BTreeNode* loadTopNode(std::istream& in, int minDegree, int flags, int depth, int splitDepth,
+                                  std::vector<BTreeNode**>& slots, std::vector<uint8_t>& scratch);
 };
 
 #endif // BTREEPERSISTENCE_H
@@ -0,0 +1,48 @@
+#ifndef BTREESTATS_H
+#define BTREESTATS_H
+
+#include <atomic>
+#include <cstdint>
+
+// Contadores de instrumentação da Árvore B e da sua persistência.
+//
+// Só são atualizados quando o projeto é compilado com BTREE_ENABLE_STATS
+// (opção de mesmo nome no CMake); sem ela BTREE_STAT_ADD não gera código.
+// Os incrementos são atômicos relaxados, então valem também com as threads
+// de carga paralela e de snapshot.
+struct BTreeStatsSnapshot {
+    uint64_t nodeVisits = 0;      // Páginas visitadas nas buscas do PagedBTree.
+    uint64_t nodeAllocations = 0; // Nós criados ao carregar ou montar árvores.
+    uint64_t postingsDecoded = 0; // Listas comprimidas expandidas na carga.
+    uint64_t journalRecords = 0;  // Registros anexados ao write-ahead log.
+};
+
+class BTreeStats {
+public:
+    static BTreeStats& global();
+
+    static constexpr bool enabled() {
+#ifdef BTREE_ENABLE_STATS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    BTreeStatsSnapshot read() const;
+    void reset();
+
+    std::atomic<uint64_t> nodeVisits{0};
+    std::atomic<uint64_t> nodeAllocations{0};
+    std::atomic<uint64_t> postingsDecoded{0};
+    std::atomic<uint64_t> journalRecords{0};
+};
+
+#ifdef BTREE_ENABLE_STATS
+#define BTREE_STAT_ADD(counter, amount) \
+    BTreeStats::global().counter.fetch_add((amount), std::memory_order_relaxed)
+#else
+#define BTREE_STAT_ADD(counter, amount) ((void)0)
+#endif
+
+#endif // BTREESTATS_H
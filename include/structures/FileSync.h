@@ -0,0 +1,29 @@
+#ifndef FILESYNC_H
+#define FILESYNC_H
+
+#include <cstdio>
+#include <string>
+
+// Utilitários para que arquivos gravados sobrevivam a uma queda de energia,
+// e não só ao fim do processo. Sem fsync os dados ficam apenas no cache do
+// sistema operacional. Onde não há suporte as funções não fazem nada.
+
+// Grava no disco o conteúdo de um arquivo já fechado.
+bool syncFile(const std::string& path);
+
+// Grava no disco o diretório de "path", tornando duráveis a criação ou o
+// rename do arquivo.
+bool syncParentDirectory(const std::string& path);
+
+// fflush seguido de fsync de um arquivo aberto.
+bool syncStream(std::FILE* file);
+
+// Arquivo temporário onde se grava a nova versão de "filename".
+std::string tempPathFor(const std::string& filename);
+
+// Torna a versão gravada em tempFile a atual: fsync, rename atômico por
+// cima de filename e fsync do diretório. Em caso de falha o temporário é
+// removido e a versão anterior de filename continua intacta.
+bool commitFile(const std::string& tempFile, const std::string& filename);
+
+#endif // FILESYNC_H
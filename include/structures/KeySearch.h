@@ -0,0 +1,32 @@
+#ifndef KEYSEARCH_H
+#define KEYSEARCH_H
+
+#include <cstdint>
+
+// Busca da posição de uma chave num array ordenado de achievementCount.
+//
+// A versão vetorizada compara 8 (AVX2) ou 4 (SSE2) chaves por instrução e
+// conta quantas são menores que o alvo. A implementação é escolhida uma vez,
+// em tempo de execução, conforme o processador; fora de x86 usa a escalar.
+class KeySearch {
+public:
+    // As chaves são lidas em blocos deste tamanho.
+    static constexpr int LANES = 8;
+
+    // Quantidade de posições a reservar para "count" chaves.
+    static int paddedCount(int count);
+
+    // Índice da primeira chave >= target (mesmo contrato de BTreeNode::findKey).
+    // "keys" deve ter paddedCount(count) posições legíveis, com as sobras
+    // após "count" preenchidas com INT32_MAX.
+    static int lowerBound(const int32_t* keys, int count, int target);
+
+    // Nome da implementação escolhida ("avx2", "sse2" ou "scalar").
+    static const char* implementationName();
+
+    // lowerBound com uma implementação específica, para comparar as
+    // variantes entre si. Retorna -1 se o processador não a suportar.
+    static int lowerBoundWith(const char* implementation, const int32_t* keys, int count, int target);
+};
+
+#endif // KEYSEARCH_H
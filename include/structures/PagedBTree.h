@@ -0,0 +1,93 @@
+#ifndef PAGEDBTREE_H
+#define PAGEDBTREE_H
+
+#include "../data/MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Formato paginado da Árvore B em disco.
+//
+// O arquivo é dividido em páginas de tamanho fixo: a página 0 guarda o
+// cabeçalho e cada página seguinte guarda exatamente um nó. Os filhos são
+// referenciados pelo deslocamento (offset) da sua página no arquivo e as
+// listas de jogadores ficam numa área contígua após a última página.
+//
+//   [cabeçalho][raiz][nó][nó]...[playerIds da chave 0][playerIds da chave 1]...
+//
+// Layout de uma página de nó (estrutura de arrays, ver PagedNodeLayout):
+//   PagedNodeHeader
+//   int32_t  achievementCounts[slots]  alinhado a 32 bytes; sobras = INT32_MAX
+//   uint32_t postingLengths[slots]     quantidade de playerIds de cada chave
+//   uint64_t postingOffsets[slots]     offset absoluto do primeiro playerId
+//   uint64_t children[2t]
+// Os achievementCount ficam contíguos, então a busca dentro do nó lê só as
+// linhas de cache das chaves e pode compará-las com SIMD (KeySearch).
+
+struct PagedFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t minDegree;
+    uint32_t pageSize;
+    uint64_t rootOffset;     // 0 quando a árvore está vazia.
+    uint64_t nodeCount;
+    uint64_t postingsOffset; // Início da área de playerIds.
+};
+
+struct PagedNodeHeader {
+    int32_t keyCount;
+    uint8_t isLeaf;
+    uint8_t padding[3];
+};
+
+// Posições (em bytes, a partir do início da página) de cada array do nó.
+struct PagedNodeLayout {
+    int keySlots;             // 2t-1 arredondado para KeySearch::paddedCount.
+    uint32_t countsOffset;
+    uint32_t lengthsOffset;
+    uint32_t postingOffsetsOffset;
+    uint32_t childrenOffset;
+    uint32_t pageSize;        // Alinhado a 64 bytes.
+
+    static PagedNodeLayout forDegree(int minDegree);
+};
+
+// Árvore B somente leitura aberta sobre um arquivo paginado.
+// Abrir custa tempo constante: nenhum nó é lido até que uma busca desça por
+// ele, e o sistema operacional carrega sob demanda apenas as páginas tocadas.
+class PagedBTree {
+public:
+    static constexpr uint32_t MAGIC = 0x47504254; // "TBPG"
+    static constexpr uint32_t VERSION = 2;
+
+    PagedBTree();
+
+    // Mapeia o arquivo e valida o cabeçalho. Retorna false se for inválido.
+    bool open(const std::string& filename);
+    void close();
+
+    // Mesma semântica de BTree::search e BTree::searchRange.
+    std::vector<int> search(int achievementCount) const;
+    std::vector<int> searchRange(int minCount, int maxCount) const;
+
+    int getMinDegree() const;
+    uint64_t getNodeCount() const;
+
+private:
+    const PagedNodeHeader* nodeAt(uint64_t offset) const;
+    const int32_t* countsOf(const PagedNodeHeader* node) const;
+    const uint64_t* childrenOf(const PagedNodeHeader* node) const;
+    // Offset do filho "index" do nó na página "offset", ou 0 se for inválido.
+    // As páginas são gravadas em largura, então um filho válido sempre vem
+    // depois do pai; um offset que volta indicaria um ciclo.
+    uint64_t childOffset(const PagedNodeHeader* node, uint64_t offset, int index) const;
+    int findKey(const PagedNodeHeader* node, int achievementCount) const;
+    void appendPosting(const PagedNodeHeader* node, int index, std::vector<int>& result) const;
+    void searchRangeNode(uint64_t offset, int minCount, int maxCount, std::vector<int>& result) const;
+
+    MappedFile file;
+    PagedFileHeader header;
+    PagedNodeLayout layout;
+};
+
+#endif // PAGEDBTREE_H
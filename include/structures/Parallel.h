@@ -0,0 +1,16 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+// Utilitários de paralelismo usados na persistência e nos índices.
+
+// Converte o parâmetro de threads das APIs: valores <= 0 usam todos os núcleos.
+int resolveThreadCount(int threadCount);
+
+// Executa work(0..count-1) distribuindo os índices entre até "threads"
+// threads. Com uma thread (ou um único item) roda na thread atual.
+void parallelFor(size_t count, int threads, const std::function<void(size_t)>& work);
+
+#endif // PARALLEL_H
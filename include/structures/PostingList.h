@@ -0,0 +1,62 @@
+#ifndef POSTINGLIST_H
+#define POSTINGLIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lista de playerIds comprimida.
+//
+// Os ids são ordenados e gravados como diferenças (deltas) entre vizinhos em
+// varint, o que reduz listas densas a cerca de 1 byte por jogador. A lista é
+// dividida em blocos de BLOCK_SIZE ids; cada bloco começa com o valor
+// absoluto (zigzag) e guarda uma entrada de salto, de modo que contains() e
+// intersect() pulam blocos inteiros sem decodificá-los.
+class PostingList {
+public:
+    static constexpr size_t BLOCK_SIZE = 128;
+
+    PostingList();
+
+    // Comprime os ids (não precisam estar ordenados; repetições são mantidas).
+    static PostingList encode(const std::vector<int>& playerIds);
+
+    // Reconstrói a lista a partir dos bytes gravados por getBytes().
+    // Retorna false se os bytes não contiverem exatamente "count" ids.
+    static bool fromBytes(const uint8_t* data, size_t length, uint32_t count, PostingList& out);
+
+    // Decodifica bytes gravados por getBytes() direto em "out" (anexando),
+    // sem montar a tabela de saltos nem copiar os bytes. É o caminho usado
+    // na carga da árvore, onde a lista só é expandida uma vez.
+    static bool decodeBytes(const uint8_t* data, size_t length, uint32_t count, std::vector<int>& out);
+
+    // Devolve os ids em ordem crescente.
+    std::vector<int> decode() const;
+    void decodeInto(std::vector<int>& out) const;
+
+    bool contains(int playerId) const;
+
+    // Ids presentes nas duas listas, em ordem crescente. Um id repetido
+    // aparece tantas vezes quanto na lista com menos repetições dele, como
+    // em std::set_intersection.
+    static std::vector<int> intersect(const PostingList& a, const PostingList& b);
+
+    uint32_t size() const;
+    bool empty() const;
+    const std::vector<uint8_t>& getBytes() const;
+
+private:
+    struct Skip {
+        int firstValue;  // Primeiro id do bloco.
+        size_t offset;   // Posição do bloco em bytes.
+    };
+
+    size_t decodeBlock(size_t block, int* out) const;
+    bool rebuildSkips();
+
+    std::vector<uint8_t> bytes;
+    std::vector<Skip> skips;
+    uint32_t count;
+};
+
+#endif // POSTINGLIST_H
@@ -0,0 +1,107 @@
+#ifndef PURCHASEINDEX_H
+#define PURCHASEINDEX_H
+
+#include "../data/MappedFile.h"
+#include "../entities/PurchasedGame.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Trecho somente leitura de ids ordenados, apontando para dentro do índice.
+struct IdSpan {
+    const int* data = nullptr;
+    size_t count = 0;
+
+    const int* begin() const { return data; }
+    const int* end() const { return data + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+// Índice de posse de jogos em formato CSR (compressed sparse row) nos dois
+// sentidos: jogador -> jogos e jogo -> jogadores.
+//
+// Cada sentido guarda três arrays: os ids de origem ordenados (keys), o
+// início da lista de cada um (offsets, com keys + 1 posições) e todas as
+// listas de vizinhos concatenadas, cada uma ordenada e sem repetições.
+// Assim "quais jogos o jogador X tem" é uma busca binária mais um trecho
+// contíguo, e interseções (jogos em comum) são um merge de listas ordenadas.
+//
+// O arquivo gravado por saveToFile tem exatamente esses arrays, alinhados a
+// 8 bytes, e openFile os usa direto do mapeamento em memória, sem reconstruir.
+class PurchaseIndex {
+public:
+    static constexpr uint32_t MAGIC = 0x58444950; // "PIDX"
+    static constexpr uint32_t VERSION = 1;
+
+    PurchaseIndex();
+
+    PurchaseIndex(const PurchaseIndex&) = delete;
+    PurchaseIndex& operator=(const PurchaseIndex&) = delete;
+
+    // Monta os dois sentidos a partir das compras (repetições são ignoradas).
+    // threadCount <= 0 usa todos os núcleos.
+    void build(const std::vector<PurchasedGame>& purchases, int threadCount = 0);
+
+    bool saveToFile(const std::string& filename) const;
+    bool openFile(const std::string& filename);
+    void clear();
+
+    IdSpan gamesOf(int playerId) const;
+    IdSpan ownersOf(int gameId) const;
+    bool owns(int playerId, int gameId) const;
+
+    // Jogos que os dois jogadores possuem / jogadores que possuem os dois jogos.
+    std::vector<int> sharedGames(int playerA, int playerB) const;
+    std::vector<int> commonOwners(int gameA, int gameB) const;
+
+    // Interseção de duas listas ordenadas. Quando uma é muito menor, usa
+    // busca exponencial na maior em vez de percorrê-la inteira.
+    static std::vector<int> intersect(IdSpan a, IdSpan b);
+
+    size_t getPlayerCount() const;
+    size_t getGameCount() const;
+    size_t getPurchaseCount() const;
+
+private:
+    // Um sentido do índice. Os ponteiros apontam para os vetores próprios
+    // (após build) ou para o arquivo mapeado (após openFile).
+    struct Adjacency {
+        const int* keys = nullptr;
+        const uint64_t* offsets = nullptr;
+        const int* neighbors = nullptr;
+        uint64_t keyCount = 0;
+        uint64_t edgeCount = 0;
+
+        std::vector<int> ownedKeys;
+        std::vector<uint64_t> ownedOffsets;
+        std::vector<int> ownedNeighbors;
+
+        IdSpan row(int key) const;
+        void pointToOwned();
+    };
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t playerKeyCount;
+        uint64_t playerEdgeCount;
+        uint64_t gameKeyCount;
+        uint64_t gameEdgeCount;
+    };
+
+    static void buildAdjacency(const std::vector<PurchasedGame>& purchases, bool byPlayer,
+                               int threads, Adjacency& out);
+    static size_t sectionBytes(uint64_t keyCount, uint64_t edgeCount);
+    static void writeAdjacency(std::ofstream& out, const Adjacency& adjacency);
+    static const char* mapAdjacency(const char* cursor, uint64_t keyCount, uint64_t edgeCount,
+                                    Adjacency& adjacency);
+
+    Adjacency playerToGames;
+    Adjacency gameToPlayers;
+    MappedFile file;
+};
+
+#endif // PURCHASEINDEX_H
@@ -0,0 +1,75 @@
+#include "../../include/data/MappedFile.h"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MAPPEDFILE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : mappedData(nullptr), mappedSize(0) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+#ifdef MAPPEDFILE_USE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // O descritor pode ser fechado logo após o mapeamento.
+    ::close(fd);
+    if (addr == MAP_FAILED) return false;
+    mappedData = (const char*)addr;
+    mappedSize = (size_t)st.st_size;
+    return true;
+#else
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    std::streamsize len = in.tellg();
+    if (len <= 0) return false;
+    fallbackBuffer.resize((size_t)len);
+    in.seekg(0);
+    if (!in.read(fallbackBuffer.data(), len)) {
+        fallbackBuffer.clear();
+        return false;
+    }
+    mappedData = fallbackBuffer.data();
+    mappedSize = fallbackBuffer.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef MAPPEDFILE_USE_MMAP
+    if (mappedData) {
+        munmap((void*)mappedData, mappedSize);
+    }
+#else
+    fallbackBuffer.clear();
+    fallbackBuffer.shrink_to_fit();
+#endif
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
+bool MappedFile::isOpen() const {
+    return mappedData != nullptr;
+}
+
+const char* MappedFile::data() const {
+    return mappedData;
+}
+
+size_t MappedFile::size() const {
+    return mappedSize;
+}
@@ -0,0 +1,117 @@
+#include "../../include/structures/BTreeBuilder.h"
+#include <algorithm>
+
+BTreeBuilder::BTreeBuilder(int minDegree, double fillFactor) : minDegree(minDegree), built(false) {
+    int maxKeys = 2 * minDegree - 1;
+    nodeCapacity = (int)(fillFactor * maxKeys);
+    nodeCapacity = std::max(minDegree - 1, std::min(nodeCapacity, maxKeys));
+    nodeCapacity = std::max(nodeCapacity, 1);
+}
+
+bool BTreeBuilder::add(int achievementCount, int playerId) {
+    if (built) return false;
+    if (!keys.empty()) {
+        AchievementKey& last = keys.back();
+        if (achievementCount < last.achievementCount) return false;
+        if (achievementCount == last.achievementCount) {
+            last.playerIds.push_back(playerId);
+            return true;
+        }
+    }
+    keys.emplace_back();
+    keys.back().achievementCount = achievementCount;
+    keys.back().playerIds.push_back(playerId);
+    return true;
+}
+
+void BTreeBuilder::build() {
+    if (built) return;
+    built = true;
+    levels.clear();
+    if (keys.empty()) return;
+
+    Level leaves;
+    leaves.sequence.resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        leaves.sequence[i] = i;
+    }
+    levels.push_back(std::move(leaves));
+
+    // Cada nível vira nós e entrega seus separadores ao nível de cima,
+    // até que um nível caiba num único nó (a raiz).
+    while (true) {
+        std::vector<size_t> separators;
+        splitLevel(levels.back(), separators);
+        if (levels.size() > 1) {
+            // Os filhos de cada nó são os nós consecutivos do nível abaixo.
+            Level& level = levels.back();
+            size_t child = 0;
+            level.firstChild.resize(level.nodeKeyCount.size());
+            for (size_t n = 0; n < level.nodeKeyCount.size(); ++n) {
+                level.firstChild[n] = child;
+                child += level.nodeKeyCount[n] + 1;
+            }
+        }
+        if (separators.empty()) break;
+        Level parent;
+        parent.sequence = std::move(separators);
+        levels.push_back(std::move(parent));
+    }
+}
+
+void BTreeBuilder::splitLevel(Level& level, std::vector<size_t>& separators) const {
+    size_t total = level.sequence.size();
+    size_t capacity = (size_t)nodeCapacity;
+    size_t minKeys = (size_t)(minDegree - 1);
+
+    // Com P nós há P-1 separadores, logo P = ceil((total + 1) / (capacidade + 1)).
+    size_t nodes = (total + capacity + 1) / (capacity + 1);
+    // Com fator de ocupação baixo a divisão pode deixar nós abaixo do
+    // mínimo de t-1 chaves; nesse caso usa menos nós, mais cheios.
+    while (nodes > 1 && (total - (nodes - 1)) / nodes < minKeys) {
+        --nodes;
+    }
+
+    size_t nodeKeys = total - (nodes - 1);
+    size_t base = nodeKeys / nodes;
+    size_t extra = nodeKeys % nodes;
+    size_t pos = 0;
+    level.nodeStart.reserve(nodes);
+    level.nodeKeyCount.reserve(nodes);
+    for (size_t n = 0; n < nodes; ++n) {
+        size_t count = base + (n < extra ? 1 : 0);
+        level.nodeStart.push_back(pos);
+        level.nodeKeyCount.push_back((int)count);
+        pos += count;
+        if (n + 1 < nodes) {
+            separators.push_back(level.sequence[pos]);
+            ++pos;
+        }
+    }
+}
+
+int BTreeBuilder::getMinDegree() const {
+    return minDegree;
+}
+
+size_t BTreeBuilder::getKeyCount() const {
+    return keys.size();
+}
+
+size_t BTreeBuilder::getNodeCount() const {
+    size_t count = 0;
+    for (const Level& level : levels) {
+        count += level.nodeKeyCount.size();
+    }
+    return count;
+}
+
+bool BTreeBuilder::isBuilt() const {
+    return built;
+}
+
+void BTreeBuilder::clear() {
+    keys.clear();
+    levels.clear();
+    built = false;
+}
@@ -0,0 +1,214 @@
+#include "../../include/structures/BTreeJournal.h"
+#include "../../include/structures/BTreePersistence.h"
+#include "../../include/structures/BTreeStats.h"
+#include "../../include/structures/FileSync.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+BTreeJournal::BTreeJournal(size_t checkpointInterval)
+    : out(nullptr), minDegree(0), lastLsn(0), recordCount(0), checkpointInterval(checkpointInterval) {}
+
+BTreeJournal::~BTreeJournal() {
+    close();
+}
+
+std::string BTreeJournal::pathFor(const std::string& snapshotFile) {
+    return snapshotFile + ".wal";
+}
+
+bool BTreeJournal::open(const std::string& snapshotFile, int minDegree) {
+    close();
+    logPath = pathFor(snapshotFile);
+    this->minDegree = minDegree;
+    int logDegree = readMinDegree(logPath);
+    if (logDegree != 0 && logDegree != minDegree) {
+        std::cerr << "Erro: Log criado para outro grau minimo: " << logPath << std::endl;
+        return false;
+    }
+    uint64_t snapshotLsn = BTreePersistence::readCheckpointLsn(snapshotFile);
+    if (logDegree == 0) {
+        // Log inexistente ou sem cabeçalho válido: começa um novo.
+        lastLsn = snapshotLsn;
+        return truncate();
+    }
+
+    std::vector<Record> records;
+    uint64_t logLsn = 0;
+    uint64_t validBytes = scan(logPath, &records, logLsn);
+
+    // Remove um registro incompleto no fim, senão os próximos ficariam
+    // depois de lixo e nunca seriam reaplicados.
+    std::error_code ec;
+    if (std::filesystem::file_size(logPath, ec) != validBytes) {
+        std::filesystem::resize_file(logPath, validBytes, ec);
+        if (ec) {
+            std::cerr << "Erro: Nao foi possivel reparar o log: " << logPath << std::endl;
+            return false;
+        }
+    }
+
+    lastLsn = std::max(snapshotLsn, logLsn);
+    recordCount = (size_t)std::count_if(records.begin(), records.end(),
+                                        [&](const Record& r) { return r.lsn > snapshotLsn; });
+
+    out = std::fopen(logPath.c_str(), "ab");
+    if (!out) {
+        std::cerr << "Erro: Nao foi possivel abrir o log para escrita: " << logPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void BTreeJournal::close() {
+    if (out) {
+        flush();
+        std::fclose(out);
+        out = nullptr;
+    }
+    pending.clear();
+}
+
+bool BTreeJournal::isOpen() const {
+    return out != nullptr;
+}
+
+void BTreeJournal::logInsert(int achievementCount, int playerId) {
+    append(OP_INSERT, achievementCount, playerId);
+}
+
+void BTreeJournal::logRemove(int achievementCount, int playerId) {
+    append(OP_REMOVE, achievementCount, playerId);
+}
+
+void BTreeJournal::append(uint8_t op, int achievementCount, int playerId) {
+    Record record;
+    record.lsn = ++lastLsn;
+    record.op = op;
+    record.achievementCount = achievementCount;
+    record.playerId = playerId;
+    record.checksum = checksumOf(record);
+    pending.push_back(record);
+    ++recordCount;
+    BTREE_STAT_ADD(journalRecords, 1);
+}
+
+bool BTreeJournal::flush() {
+    if (!out) return false;
+    if (!pending.empty()) {
+        size_t written = std::fwrite(pending.data(), sizeof(Record), pending.size(), out);
+        if (written != pending.size()) {
+            std::cerr << "Erro: Falha ao escrever no log: " << logPath << std::endl;
+            return false;
+        }
+        pending.clear();
+    }
+    if (!syncStream(out)) {
+        std::cerr << "Erro: Nao foi possivel gravar o log no disco: " << logPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BTreeJournal::truncate() {
+    if (logPath.empty()) return false;
+    // Registros ainda não gravados também já estão no snapshot.
+    pending.clear();
+    recordCount = 0;
+    if (out) {
+        std::fclose(out);
+        out = nullptr;
+    }
+    return writeHeader();
+}
+
+bool BTreeJournal::writeHeader() {
+    out = std::fopen(logPath.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Erro: Nao foi possivel abrir o log para escrita: " << logPath << std::endl;
+        return false;
+    }
+    LogHeader header;
+    header.magic = LOG_MAGIC;
+    header.minDegree = minDegree;
+    // O diretório também é gravado, para o log recém-criado não sumir.
+    if (std::fwrite(&header, sizeof(header), 1, out) != 1 || !syncStream(out) ||
+        !syncParentDirectory(logPath)) {
+        std::cerr << "Erro: Nao foi possivel gravar o log no disco: " << logPath << std::endl;
+        std::fclose(out);
+        out = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool BTreeJournal::shouldCheckpoint() const {
+    return recordCount >= checkpointInterval;
+}
+
+uint64_t BTreeJournal::getLastLsn() const {
+    return lastLsn;
+}
+
+size_t BTreeJournal::getRecordCount() const {
+    return recordCount;
+}
+
+size_t BTreeJournal::replay(const std::string& logFile, BTree* tree, uint64_t afterLsn) {
+    std::vector<Record> records;
+    uint64_t logLsn = 0;
+    scan(logFile, &records, logLsn);
+    size_t applied = 0;
+    for (const Record& record : records) {
+        if (record.lsn <= afterLsn) continue; // Já incluído no snapshot.
+        if (record.op == OP_INSERT) {
+            tree->insert(record.achievementCount, record.playerId);
+        } else {
+            tree->remove(record.achievementCount, record.playerId);
+        }
+        ++applied;
+    }
+    return applied;
+}
+
+uint32_t BTreeJournal::checksumOf(const Record& record) {
+    // FNV-1a sobre todos os campos exceto o próprio checksum.
+    const uint8_t* bytes = (const uint8_t*)&record;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(Record, checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+int BTreeJournal::readMinDegree(const std::string& logFile) {
+    std::ifstream in(logFile, std::ios::binary);
+    LogHeader header;
+    if (!in.read((char*)&header, sizeof(header)) || header.magic != LOG_MAGIC) {
+        return 0;
+    }
+    return header.minDegree;
+}
+
+uint64_t BTreeJournal::scan(const std::string& logFile, std::vector<Record>* records, uint64_t& lastLsn) {
+    std::ifstream in(logFile, std::ios::binary);
+    lastLsn = 0;
+    LogHeader header;
+    if (!in.read((char*)&header, sizeof(header)) || header.magic != LOG_MAGIC) {
+        return 0;
+    }
+    uint64_t validBytes = sizeof(header);
+    Record record;
+    while (in.read((char*)&record, sizeof(Record))) {
+        bool valid = record.checksum == checksumOf(record) &&
+                     (record.op == OP_INSERT || record.op == OP_REMOVE) &&
+                     record.lsn > lastLsn;
+        if (!valid) break;
+        lastLsn = record.lsn;
+        validBytes += sizeof(Record);
+        if (records) records->push_back(record);
+    }
+    return validBytes;
+}
@@ -1,85 +1,791 @@
 #include "../../include/structures/BTreePersistence.h"
 #include "../../include/structures/BTree.h"
 #include "../../include/structures/BTreeNode.h"
+#include "../../include/structures/BTreeStats.h"
+#include "../../include/structures/FileSync.h"
+#include "../../include/structures/Parallel.h"
+#include "../../include/structures/PostingList.h"
+#include "../../include/data/MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
-void BTreePersistence::saveToFile(BTree* tree, const std::string& filename) {
-    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+namespace {
+
+// Expõe um trecho de memória como istream sem copiá-lo.
+class MemoryBuffer : public std::streambuf {
+public:
+    MemoryBuffer(const char* data, size_t size) {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + size);
+    }
+
+protected:
+    // Permite tellg()/seekg() para achar as subárvores dentro do mapeamento.
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+        char* target = (dir == std::ios_base::beg) ? eback() + off
+                     : (dir == std::ios_base::cur) ? gptr() + off
+                     : egptr() + off;
+        if (target < eback() || target > egptr()) return pos_type(off_type(-1));
+        setg(eback(), target, egptr());
+        return pos_type(target - eback());
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+        return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+};
+
+// Lê "count" elementos para "out". O tamanho vem do arquivo e só vira uma
+// alocação única depois de conferido: com o arquivo mapeado in_avail() é
+// tudo o que resta dele. Nos outros casos o vetor cresce em blocos, e um
+// tamanho corrompido falha no fim dos dados em vez de alocar gigabytes.
+template <typename T>
+bool readArray(std::istream& in, std::vector<T>& out, uint64_t count) {
+    const uint64_t chunk = (1 << 20) / sizeof(T);
+    std::streamsize available = in.rdbuf()->in_avail();
+    if (available >= 0 && count <= (uint64_t)available / sizeof(T)) {
+        out.resize((size_t)count);
+        in.read((char*)out.data(), (std::streamsize)(count * sizeof(T)));
+        return (bool)in;
+    }
+    out.clear();
+    while (count > 0 && in) {
+        size_t n = (size_t)std::min(count, chunk);
+        size_t oldSize = out.size();
+        out.resize(oldSize + n);
+        in.read((char*)(out.data() + oldSize), (std::streamsize)(n * sizeof(T)));
+        count -= n;
+    }
+    return (bool)in;
+}
+
+// Bytes entre a posição de leitura e o fim de "in", sem mover a leitura.
+uint64_t remainingBytes(std::istream& in) {
+    std::streamoff pos = in.tellg();
+    if (pos < 0) return 0;
+    std::streamoff end = (std::streamoff)in.rdbuf()->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+    in.seekg(pos);
+    return end >= pos ? (uint64_t)(end - pos) : 0;
+}
+
+} // namespace
+
+void BTreePersistence::saveToFile(BTree* tree, const std::string& filename, const BTreeSaveOptions& options) {
+    writeSnapshot(tree, filename, flagsFor(options), 0, options.threadCount);
+}
+
+bool BTreePersistence::writeSnapshot(BTree* tree, const std::string& filename, int flags, uint64_t lsn,
+                                     int threadCount) {
+    if (hasUncoveredLog(filename, flags)) {
+        return false;
+    }
+    std::string tempFile = tempPathFor(filename);
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
     if (!out) {
         std::cerr << "Erro: Nao foi possivel abrir o arquivo para escrita: " << filename << std::endl;
-        return;
+        return false;
+    }
+    saveTree(out, tree, flags, lsn, threadCount);
+    out.close();
+    if (!out) {
+        std::cerr << "Erro: Falha ao escrever o arquivo: " << filename << std::endl;
+        std::remove(tempFile.c_str());
+        return false;
     }
+    return commitFile(tempFile, filename);
+}
+
+void BTreePersistence::saveTree(std::ostream& out, BTree* tree, int flags, uint64_t lsn, int threadCount) {
     // Acesso permitido pois BTreePersistence é 'friend' de BTree.
-    int t = tree->minDegree;
-    out.write((char*)&t, sizeof(int)); // Salva o grau mínimo primeiro.
+    writeHeader(out, tree->minDegree, flags, lsn); // Salva o grau mínimo primeiro.
+    if (!(flags & FLAG_SUBTREE_TABLE)) {
+        if (tree->root) {
+            saveNode(out, tree->root, flags);
+        }
+        return;
+    }
+
+    // Desce nível a nível até haver subárvores suficientes para ocupar
+    // as threads (algumas por thread, para equilibrar tamanhos diferentes).
+    int threads = resolveThreadCount(threadCount);
+    size_t target = (size_t)threads * 4;
+    int splitDepth = 0;
+    std::vector<BTreeNode*> frontier;
     if (tree->root) {
-        saveNode(out, tree->root);
+        frontier.push_back(tree->root);
     }
-    out.close();
+    while (!frontier.empty() && frontier.size() < target && !frontier[0]->isLeaf) {
+        std::vector<BTreeNode*> next;
+        for (BTreeNode* node : frontier) {
+            for (int i = 0; i <= node->keyCount; ++i) {
+                next.push_back(node->children[i]);
+            }
+        }
+        frontier.swap(next);
+        ++splitDepth;
+    }
+
+    // Layout: [splitDepth][níveis de cima][quantidade][tamanhos][subárvores]
+    out.write((char*)&splitDepth, sizeof(int));
+    if (splitDepth > 0) {
+        saveTopNode(out, tree->root, 0, splitDepth, flags);
+    }
+    uint64_t count = frontier.size();
+    out.write((char*)&count, sizeof(uint64_t));
+    // Os tamanhos só são conhecidos depois de codificar; a tabela é
+    // reservada agora e preenchida no fim.
+    std::streampos table = out.tellp();
+    std::vector<uint64_t> sizes(frontier.size(), 0);
+    out.write((char*)sizes.data(), sizes.size() * sizeof(uint64_t));
+
+    // Codifica um lote de "threads" subárvores por vez e o grava antes do
+    // próximo, para que só um lote fique em memória (e não o arquivo todo).
+    std::vector<std::string> blobs(threads);
+    for (size_t first = 0; first < frontier.size(); first += blobs.size()) {
+        size_t batch = std::min(blobs.size(), frontier.size() - first);
+        parallelFor(batch, threads, [&](size_t i) {
+            std::ostringstream buffer(std::ios::binary);
+            saveNode(buffer, frontier[first + i], flags);
+            blobs[i] = buffer.str();
+        });
+        for (size_t i = 0; i < batch; ++i) {
+            sizes[first + i] = blobs[i].size();
+            out.write(blobs[i].data(), blobs[i].size());
+            std::string().swap(blobs[i]);
+        }
+    }
+
+    std::streampos end = out.tellp();
+    out.seekp(table);
+    out.write((char*)sizes.data(), sizes.size() * sizeof(uint64_t));
+    out.seekp(end);
 }
 
-// Assinatura corrigida para corresponder à declaração no .h
-BTree* BTreePersistence::loadFromFile(const std::string& filename) {
-    std::ifstream in(filename, std::ios::binary);
+void BTreePersistence::saveTopNode(std::ostream& out, BTreeNode* node, int depth, int splitDepth, int flags) {
+    out.write((char*)&node->keyCount, sizeof(int));
+    out.write((char*)&node->isLeaf, sizeof(bool));
+    for (int i = 0; i < node->keyCount; ++i) {
+        saveKey(out, node->keys[i], flags);
+    }
+    if (!node->isLeaf && depth + 1 < splitDepth) {
+        for (int i = 0; i <= node->keyCount; ++i) {
+            saveTopNode(out, node->children[i], depth + 1, splitDepth, flags);
+        }
+    }
+}
+
+bool BTreePersistence::loadTree(std::istream& in, int minDegree, int flags, int threadCount,
+                                const char* base, BTreeNode*& root) {
+    std::vector<uint8_t> scratch;
+    root = nullptr;
+    if (!(flags & FLAG_SUBTREE_TABLE)) {
+        if (in.peek() == std::ifstream::traits_type::eof()) return true; // Árvore vazia.
+        root = loadNode(in, minDegree, flags, scratch);
+        if (!in) {
+            std::cerr << "Erro: Arquivo da arvore truncado ou corrompido." << std::endl;
+            delete root;
+            root = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    int splitDepth = 0;
+    in.read((char*)&splitDepth, sizeof(int));
+    std::vector<BTreeNode**> slots;
+    if (splitDepth > 0) {
+        root = loadTopNode(in, minDegree, flags, 0, splitDepth, slots, scratch);
+    }
+    uint64_t count = 0;
+    in.read((char*)&count, sizeof(uint64_t));
+    if (splitDepth == 0 && count == 1) {
+        slots.push_back(&root); // A raiz inteira é a única subárvore.
+    }
+    if (!in || count != slots.size()) {
+        std::cerr << "Erro: Tabela de subarvores corrompida." << std::endl;
+        delete root;
+        root = nullptr;
+        return false;
+    }
+
+    std::vector<uint64_t> sizes(count);
+    if (count > 0) {
+        in.read((char*)sizes.data(), count * sizeof(uint64_t));
+    }
+    // Os tamanhos vêm do arquivo: antes de usá-los confere que cabem no que
+    // resta dele, para um arquivo truncado não ler além do fim.
+    std::streamoff pos = in.tellg();
+    uint64_t remaining = in ? remainingBytes(in) : 0;
+    for (size_t i = 0; i < count && in; ++i) {
+        if (sizes[i] > remaining) {
+            in.setstate(std::ios::failbit);
+        }
+        remaining -= std::min(sizes[i], remaining);
+    }
+    // Com o arquivo mapeado cada subárvore é lida no próprio mapeamento;
+    // sem ele, os bytes são copiados para buffers.
+    std::vector<const char*> starts(count);
+    std::vector<std::string> copies;
+    if (in && base) {
+        for (size_t i = 0; i < count; ++i) {
+            starts[i] = base + pos;
+            pos += (std::streamoff)sizes[i];
+        }
+        in.seekg(pos);
+    } else if (in) {
+        copies.resize(count);
+        for (size_t i = 0; i < count && in; ++i) {
+            copies[i].resize(sizes[i]);
+            in.read(&copies[i][0], sizes[i]);
+            starts[i] = copies[i].data();
+        }
+    }
     if (!in) {
-        // Não é um erro, o arquivo pode não existir na primeira execução.
+        std::cerr << "Erro: Arquivo truncado nas subarvores." << std::endl;
+        delete root;
+        root = nullptr;
+        return false;
+    }
+
+    // Cada subárvore é independente: decodifica em paralelo e pendura o
+    // resultado no ponteiro do pai reservado em slots.
+    std::vector<char> failed(count, 0);
+    parallelFor(count, resolveThreadCount(threadCount), [&](size_t i) {
+        MemoryBuffer memory(starts[i], sizes[i]);
+        std::istream blob(&memory);
+        std::vector<uint8_t> workerScratch;
+        *slots[i] = loadNode(blob, minDegree, flags, workerScratch);
+        failed[i] = !blob;
+    });
+    if (std::find(failed.begin(), failed.end(), 1) != failed.end()) {
+        std::cerr << "Erro: Subarvore corrompida." << std::endl;
+        delete root;
+        root = nullptr;
+        return false;
+    }
+    return true;
+}
+
+BTreeNode* BTreePersistence::loadTopNode(std::istream& in, int minDegree, int flags, int depth, int splitDepth,
+                                         std::vector<BTreeNode**>& slots, std::vector<uint8_t>& scratch) {
+    int n;
+    bool leaf;
+    in.read((char*)&n, sizeof(int));
+    in.read((char*)&leaf, sizeof(bool));
+    if (!in || n < 0 || n > 2 * minDegree - 1) {
+        in.setstate(std::ios::failbit);
         return nullptr;
     }
+    BTreeNode* node = new BTreeNode(minDegree, leaf);
+    BTREE_STAT_ADD(nodeAllocations, 1);
+    node->keyCount = n;
+    for (int i = 0; i < n; ++i) {
+        loadKey(in, node->keys[i], flags, scratch);
+    }
+    if (!leaf) {
+        for (int i = 0; i <= n && in; ++i) {
+            if (depth + 1 == splitDepth) {
+                slots.push_back(&node->children[i]);
+            } else {
+                node->children[i] = loadTopNode(in, minDegree, flags, depth + 1, splitDepth, slots, scratch);
+            }
+        }
+    }
+    return node;
+}
+
+// Assinatura corrigida para corresponder à declaração no .h
+BTree* BTreePersistence::loadFromFile(const std::string& filename, int threadCount) {
+    BTree* tree = nullptr;
+    uint64_t lsn = 0;
+    bool corrupted = false;
+    auto loadSnapshot = [&](std::istream& in, const char* base) {
+        int minDegree;
+        int flags;
+        if (!readHeader(in, minDegree, flags, lsn)) {
+            corrupted = true; // Arquivo vazio ou corrompido.
+            return;
+        }
+        BTreeNode* root = nullptr;
+        if (!loadTree(in, minDegree, flags, threadCount, base, root)) {
+            corrupted = true;
+            return;
+        }
+        tree = new BTree(minDegree);
+        tree->root = root;
+    };
+
+    // O arquivo é mapeado em memória e lido direto do mapeamento, evitando
+    // as leituras campo a campo pelo ifstream e a cópia das subárvores.
+    MappedFile mapped;
+    if (mapped.open(filename)) {
+        MemoryBuffer memory(mapped.data(), mapped.size());
+        std::istream in(&memory);
+        loadSnapshot(in, mapped.data());
+    } else {
+        std::ifstream in(filename, std::ios::binary);
+        if (in) {
+            loadSnapshot(in, nullptr);
+        }
+    }
+    if (corrupted) {
+        return nullptr;
+    }
+
+    // Reaplica as operações registradas depois do snapshot. Sem snapshot
+    // (nenhum checkpoint ainda), a árvore é recriada só a partir do log.
+    std::string logFile = BTreeJournal::pathFor(filename);
+    if (!tree) {
+        int logDegree = BTreeJournal::readMinDegree(logFile);
+        if (logDegree == 0) {
+            // Não é um erro, o arquivo pode não existir na primeira execução.
+            return nullptr;
+        }
+        std::error_code ec;
+        uintmax_t logBytes = std::filesystem::file_size(logFile, ec);
+        if (ec || !isPlausibleDegree(logDegree, (uint64_t)logBytes)) {
+            std::cerr << "Erro: Grau minimo invalido no log: " << logFile << std::endl;
+            return nullptr;
+        }
+        tree = new BTree(logDegree);
+    }
+    BTreeJournal::replay(logFile, tree, lsn);
+    return tree;
+}
+
+bool BTreePersistence::checkpoint(BTree* tree, const std::string& filename, BTreeJournal& journal,
+                                  const BTreeSaveOptions& options) {
+    // O log precisa estar no disco antes do snapshot que o substitui.
+    if (!journal.flush()) {
+        return false;
+    }
+    int flags = flagsFor(options) | FLAG_CHECKPOINT_LSN;
+    if (!writeSnapshot(tree, filename, flags, journal.getLastLsn(), options.threadCount)) {
+        return false;
+    }
+    // Se o processo morrer aqui, o snapshot já guarda o LSN e os registros
+    // antigos do log são ignorados na próxima carga.
+    return journal.truncate();
+}
+
+std::future<SnapshotResult> BTreePersistence::saveSnapshotAsync(BTree* tree, const std::string& filename,
+                                                                std::shared_mutex& treeMutex,
+                                                                const BTreeSaveOptions& options) {
+    return startSnapshot(tree, filename, treeMutex, nullptr, options);
+}
+
+std::future<SnapshotResult> BTreePersistence::saveSnapshotAsync(BTree* tree, const std::string& filename,
+                                                                std::shared_mutex& treeMutex, BTreeJournal& journal,
+                                                                const BTreeSaveOptions& options) {
+    return startSnapshot(tree, filename, treeMutex, &journal, options);
+}
+
+std::future<SnapshotResult> BTreePersistence::startSnapshot(BTree* tree, const std::string& filename,
+                                                            std::shared_mutex& treeMutex, BTreeJournal* journal,
+                                                            const BTreeSaveOptions& options) {
+    int flags = flagsFor(options);
+    if (journal) {
+        flags |= FLAG_CHECKPOINT_LSN;
+    }
+    int threadCount = options.threadCount;
+    return std::async(std::launch::async, [tree, filename, &treeMutex, journal, flags, threadCount]() {
+        using Clock = std::chrono::steady_clock;
+        SnapshotResult result;
+        Clock::time_point start = Clock::now();
+
+        if (hasUncoveredLog(filename, flags)) {
+            return result;
+        }
+
+        // Fase 1: cópia crua dos nós, o único trecho que disputa a árvore.
+        // Nada é codificado aqui; a compressão das listas fica para depois.
+        BTree copy(tree->minDegree);
+        uint64_t lsn = 0;
+        {
+            std::shared_lock<std::shared_mutex> lock(treeMutex);
+            lsn = journal ? journal->getLastLsn() : 0;
+            copy.root = cloneNode(tree->root, tree->minDegree);
+        }
+        Clock::time_point captured = Clock::now();
+
+        // Fase 2: codificação e gravação da cópia, com os escritores já
+        // liberados.
+        if (writeSnapshot(&copy, filename, flags, lsn, threadCount)) {
+            std::error_code ec;
+            result.success = true;
+            result.bytesWritten = (size_t)std::filesystem::file_size(filename, ec);
+        }
+        Clock::time_point finished = Clock::now();
+
+        result.captureMillis = std::chrono::duration<double, std::milli>(captured - start).count();
+        result.writeMillis = std::chrono::duration<double, std::milli>(finished - captured).count();
+        result.totalMillis = std::chrono::duration<double, std::milli>(finished - start).count();
+        return result;
+    });
+}
+
+BTreeNode* BTreePersistence::cloneNode(BTreeNode* node, int minDegree) {
+    if (!node) return nullptr;
+    BTreeNode* copy = new BTreeNode(minDegree, node->isLeaf);
+    BTREE_STAT_ADD(nodeAllocations, 1);
+    copy->keyCount = node->keyCount;
+    for (int i = 0; i < node->keyCount; ++i) {
+        copy->keys[i] = node->keys[i];
+    }
+    if (!node->isLeaf) {
+        for (int i = 0; i <= node->keyCount; ++i) {
+            copy->children[i] = cloneNode(node->children[i], minDegree);
+        }
+    }
+    return copy;
+}
+
+uint64_t BTreePersistence::readCheckpointLsn(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
     int minDegree;
+    int flags;
+    uint64_t lsn = 0;
+    if (!in || !readHeader(in, minDegree, flags, lsn)) {
+        return 0;
+    }
+    return lsn;
+}
+
+int BTreePersistence::flagsFor(const BTreeSaveOptions& options) {
+    int flags = 0;
+    if (options.compressPostings) flags |= FLAG_COMPRESSED_POSTINGS;
+    if (options.threadCount != 1) flags |= FLAG_SUBTREE_TABLE;
+    return flags;
+}
+
+void BTreePersistence::writeHeader(std::ostream& out, int minDegree, int flags, uint64_t lsn) {
+    if (flags != 0) {
+        int magic = FORMAT_MAGIC;
+        int version = FORMAT_VERSION;
+        out.write((char*)&magic, sizeof(int));
+        out.write((char*)&version, sizeof(int));
+        out.write((char*)&flags, sizeof(int));
+    }
+    out.write((char*)&minDegree, sizeof(int));
+    if (flags & FLAG_CHECKPOINT_LSN) {
+        out.write((char*)&lsn, sizeof(uint64_t));
+    }
+}
+
+bool BTreePersistence::readHeader(std::istream& in, int& minDegree, int& flags, uint64_t& lsn) {
+    flags = 0;
+    lsn = 0;
     in.read((char*)&minDegree, sizeof(int));
     if (in.gcount() != sizeof(int)) {
-        return nullptr; // Arquivo vazio ou corrompido.
+        return false;
     }
-    BTree* tree = new BTree(minDegree);
-    if (in.peek() != std::ifstream::traits_type::eof()) {
-        tree->root = loadNode(in, minDegree);
+    // No formato original o primeiro int já é o grau.
+    if (minDegree == FORMAT_MAGIC) {
+        int version;
+        in.read((char*)&version, sizeof(int));
+        in.read((char*)&flags, sizeof(int));
+        in.read((char*)&minDegree, sizeof(int));
+        if (!in || version > FORMAT_VERSION || (flags & ~KNOWN_FLAGS) != 0) {
+            std::cerr << "Erro: Versao de arquivo nao suportada." << std::endl;
+            return false;
+        }
+        if (flags & FLAG_CHECKPOINT_LSN) {
+            in.read((char*)&lsn, sizeof(uint64_t));
+        }
     }
-    in.close();
-    return tree;
+    if (!in) {
+        return false;
+    }
+    if (!isPlausibleDegree(minDegree, remainingBytes(in))) {
+        std::cerr << "Erro: Grau minimo invalido no arquivo: " << minDegree << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BTreePersistence::isPlausibleDegree(int minDegree, uint64_t bytesLeft) {
+    if (minDegree < 2) {
+        return false;
+    }
+    return minDegree <= MAX_UNCHECKED_DEGREE || 2 * (uint64_t)minDegree - 1 <= bytesLeft;
 }
 
-void BTreePersistence::saveNode(std::ofstream& out, BTreeNode* node) {
+void BTreePersistence::saveNode(std::ostream& out, BTreeNode* node, int flags) {
     if (!node) return;
     // Acesso permitido pois BTreePersistence é 'friend' de BTreeNode.
     out.write((char*)&node->keyCount, sizeof(int));
     out.write((char*)&node->isLeaf, sizeof(bool));
     for (int i = 0; i < node->keyCount; ++i) {
-        out.write((char*)&node->keys[i].achievementCount, sizeof(int));
-        size_t vec_size = node->keys[i].playerIds.size();
-        out.write((char*)&vec_size, sizeof(size_t));
-        if (vec_size > 0) {
-            out.write((char*)node->keys[i].playerIds.data(), vec_size * sizeof(int));
-        }
+        saveKey(out, node->keys[i], flags);
     }
     if (!node->isLeaf) {
         for (int i = 0; i <= node->keyCount; ++i) {
-            saveNode(out, node->children[i]);
+            saveNode(out, node->children[i], flags);
+        }
+    }
+}
+
+void BTreePersistence::saveKey(std::ostream& out, const AchievementKey& key, int flags) {
+    out.write((char*)&key.achievementCount, sizeof(int));
+    if (flags & FLAG_COMPRESSED_POSTINGS) {
+        PostingList list = PostingList::encode(key.playerIds);
+        uint32_t count = list.size();
+        uint32_t length = (uint32_t)list.getBytes().size();
+        out.write((char*)&count, sizeof(uint32_t));
+        out.write((char*)&length, sizeof(uint32_t));
+        if (length > 0) {
+            out.write((const char*)list.getBytes().data(), length);
+        }
+        return;
+    }
+    size_t vec_size = key.playerIds.size();
+    out.write((char*)&vec_size, sizeof(size_t));
+    if (vec_size > 0) {
+        out.write((char*)key.playerIds.data(), vec_size * sizeof(int));
+    }
+}
+
+void BTreePersistence::loadKey(std::istream& in, AchievementKey& key, int flags, std::vector<uint8_t>& scratch) {
+    in.read((char*)&key.achievementCount, sizeof(int));
+    if (flags & FLAG_COMPRESSED_POSTINGS) {
+        uint32_t count = 0;
+        uint32_t length = 0;
+        in.read((char*)&count, sizeof(uint32_t));
+        in.read((char*)&length, sizeof(uint32_t));
+        key.playerIds.clear();
+        // Cada id ocupa ao menos um byte, então count > length é corrupção.
+        if (!in || count > length || !readArray(in, scratch, length)) {
+            std::cerr << "Erro: Lista de jogadores comprimida corrompida." << std::endl;
+            in.setstate(std::ios::failbit);
+            return;
+        }
+        key.playerIds.reserve(count); // Uma única alocação, no tamanho exato.
+        if (!PostingList::decodeBytes(scratch.data(), length, count, key.playerIds)) {
+            std::cerr << "Erro: Lista de jogadores comprimida corrompida." << std::endl;
+            in.setstate(std::ios::failbit);
+            return;
         }
+        BTREE_STAT_ADD(postingsDecoded, 1);
+        return;
+    }
+    size_t vec_size = 0;
+    in.read((char*)&vec_size, sizeof(size_t));
+    if (in && vec_size > 0) {
+        readArray(in, key.playerIds, vec_size);
     }
 }
 
-BTreeNode* BTreePersistence::loadNode(std::ifstream& in, int minDegree) {
-    if (in.peek() == std::ifstream::traits_type::eof()) return nullptr;
+BTreeNode* BTreePersistence::loadNode(std::istream& in, int minDegree, int flags, std::vector<uint8_t>& scratch) {
+    // Um arquivo truncado ou com contagem impossível deixa "in" em falha;
+    // quem chamou descarta a árvore inteira.
     int n;
     bool leaf;
     in.read((char*)&n, sizeof(int));
     in.read((char*)&leaf, sizeof(bool));
+    if (!in || n < 0 || n > 2 * minDegree - 1) {
+        in.setstate(std::ios::failbit);
+        return nullptr;
+    }
     BTreeNode* node = new BTreeNode(minDegree, leaf);
+    BTREE_STAT_ADD(nodeAllocations, 1);
     node->keyCount = n;
     for (int i = 0; i < n; ++i) {
-        in.read((char*)&node->keys[i].achievementCount, sizeof(int));
-        size_t vec_size;
-        in.read((char*)&vec_size, sizeof(size_t));
-        if (vec_size > 0) {
-            node->keys[i].playerIds.resize(vec_size);
-            in.read((char*)node->keys[i].playerIds.data(), vec_size * sizeof(int));
-        }
+        loadKey(in, node->keys[i], flags, scratch);
     }
     if (!leaf) {
-        for (int i = 0; i <= n; ++i) {
-            node->children[i] = loadNode(in, minDegree);
+        for (int i = 0; i <= n && in; ++i) {
+            node->children[i] = loadNode(in, minDegree, flags, scratch);
         }
     }
     return node;
 }
+
+bool BTreePersistence::hasUncoveredLog(const std::string& filename, int flags) {
+    std::error_code ec;
+    if ((flags & FLAG_CHECKPOINT_LSN) || !std::filesystem::exists(BTreeJournal::pathFor(filename), ec)) {
+        return false;
+    }
+    std::cerr << "Erro: Snapshot sem LSN sobre um arquivo com log (use checkpoint): " << filename << std::endl;
+    return true;
+}
+
+bool BTreePersistence::savePagedToFile(BTree* tree, const std::string& filename) {
+    std::string tempFile = tempPathFor(filename);
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Erro: Nao foi possivel abrir o arquivo para escrita: " << filename << std::endl;
+        return false;
+    }
+    int t = tree->minDegree;
+    PagedNodeLayout layout = PagedNodeLayout::forDegree(t);
+    uint32_t pageSize = layout.pageSize;
+
+    // Primeira passada: numera os nós em largura. A posição de cada nó na
+    // lista define sua página, então os offsets dos filhos já são conhecidos
+    // quando o pai é escrito.
+    std::vector<BTreeNode*> nodes;
+    if (tree->root) {
+        nodes.push_back(tree->root);
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        BTreeNode* node = nodes[i];
+        if (!node->isLeaf) {
+            for (int c = 0; c <= node->keyCount; ++c) {
+                nodes.push_back(node->children[c]);
+            }
+        }
+    }
+
+    PagedFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = PagedBTree::MAGIC;
+    header.version = PagedBTree::VERSION;
+    header.minDegree = t;
+    header.pageSize = pageSize;
+    header.rootOffset = nodes.empty() ? 0 : pageSize;
+    header.nodeCount = nodes.size();
+    header.postingsOffset = (uint64_t)(nodes.size() + 1) * pageSize;
+
+    std::vector<char> page(pageSize, 0);
+    std::memcpy(page.data(), &header, sizeof(header));
+    out.write(page.data(), pageSize);
+
+    // Segunda passada: escreve uma página por nó.
+    uint64_t postingCursor = header.postingsOffset;
+    uint64_t nextChild = 2; // Página do próximo filho na ordem em largura.
+    for (BTreeNode* node : nodes) {
+        std::fill(page.begin(), page.end(), 0);
+        PagedNodeHeader* nodeHeader = (PagedNodeHeader*)page.data();
+        nodeHeader->keyCount = node->keyCount;
+        nodeHeader->isLeaf = node->isLeaf ? 1 : 0;
+        int32_t* counts = (int32_t*)(page.data() + layout.countsOffset);
+        uint32_t* lengths = (uint32_t*)(page.data() + layout.lengthsOffset);
+        uint64_t* postingOffsets = (uint64_t*)(page.data() + layout.postingOffsetsOffset);
+        uint64_t* children = (uint64_t*)(page.data() + layout.childrenOffset);
+        for (int i = 0; i < layout.keySlots; ++i) {
+            // Posições livres ficam com INT32_MAX, como exige KeySearch.
+            counts[i] = INT32_MAX;
+        }
+        for (int i = 0; i < node->keyCount; ++i) {
+            counts[i] = node->keys[i].achievementCount;
+            lengths[i] = (uint32_t)node->keys[i].playerIds.size();
+            postingOffsets[i] = postingCursor;
+            postingCursor += (uint64_t)lengths[i] * sizeof(int);
+        }
+        if (!node->isLeaf) {
+            for (int c = 0; c <= node->keyCount; ++c) {
+                children[c] = (nextChild++) * pageSize;
+            }
+        }
+        out.write(page.data(), pageSize);
+    }
+
+    // Área de playerIds, na mesma ordem usada para calcular os offsets.
+    for (BTreeNode* node : nodes) {
+        for (int i = 0; i < node->keyCount; ++i) {
+            const std::vector<int>& ids = node->keys[i].playerIds;
+            if (!ids.empty()) {
+                out.write((const char*)ids.data(), ids.size() * sizeof(int));
+            }
+        }
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Erro: Falha ao escrever o arquivo paginado: " << filename << std::endl;
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    return commitFile(tempFile, filename);
+}
+
+PagedBTree* BTreePersistence::openPaged(const std::string& filename) {
+    PagedBTree* paged = new PagedBTree();
+    if (!paged->open(filename)) {
+        delete paged;
+        return nullptr;
+    }
+    return paged;
+}
+
+BTree* BTreePersistence::buildTree(BTreeBuilder& builder) {
+    builder.build();
+    int t = builder.minDegree;
+    BTree* tree = new BTree(t);
+    std::vector<BTreeNode*> below;
+    for (size_t l = 0; l < builder.levels.size(); ++l) {
+        const BTreeBuilder::Level& level = builder.levels[l];
+        std::vector<BTreeNode*> current(level.nodeKeyCount.size());
+        for (size_t n = 0; n < current.size(); ++n) {
+            BTreeNode* node = new BTreeNode(t, l == 0);
+            BTREE_STAT_ADD(nodeAllocations, 1);
+            node->keyCount = level.nodeKeyCount[n];
+            for (int i = 0; i < node->keyCount; ++i) {
+                node->keys[i] = std::move(builder.keys[level.sequence[level.nodeStart[n] + i]]);
+            }
+            if (l > 0) {
+                for (int c = 0; c <= node->keyCount; ++c) {
+                    node->children[c] = below[level.firstChild[n] + c];
+                }
+            }
+            current[n] = node;
+        }
+        below.swap(current);
+    }
+    if (!below.empty()) {
+        tree->root = below[0];
+    }
+    builder.clear();
+    return tree;
+}
+
+bool BTreePersistence::saveBuiltToFile(BTreeBuilder& builder, const std::string& filename,
+                                       const BTreeSaveOptions& options) {
+    int flags = flagsFor(options) & ~FLAG_SUBTREE_TABLE;
+    if (hasUncoveredLog(filename, flags)) {
+        return false;
+    }
+    builder.build();
+    std::string tempFile = tempPathFor(filename);
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Erro: Nao foi possivel abrir o arquivo para escrita: " << filename << std::endl;
+        return false;
+    }
+    // O layout do builder é gravado sempre em sequência (flags acima).
+    writeHeader(out, builder.minDegree, flags, 0);
+    if (!builder.levels.empty()) {
+        saveBuiltNode(out, builder, builder.levels.size() - 1, 0, flags);
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Erro: Falha ao escrever o arquivo: " << filename << std::endl;
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    return commitFile(tempFile, filename);
+}
+
+void BTreePersistence::saveBuiltNode(std::ostream& out, const BTreeBuilder& builder, size_t level, size_t node, int flags) {
+    // Mesmo layout em pré-ordem de saveNode, lido dos níveis do builder.
+    const BTreeBuilder::Level& current = builder.levels[level];
+    int n = current.nodeKeyCount[node];
+    bool leaf = (level == 0);
+    out.write((char*)&n, sizeof(int));
+    out.write((char*)&leaf, sizeof(bool));
+    for (int i = 0; i < n; ++i) {
+        saveKey(out, builder.keys[current.sequence[current.nodeStart[node] + i]], flags);
+    }
+    if (!leaf) {
+        for (int c = 0; c <= n; ++c) {
+            saveBuiltNode(out, builder, level - 1, current.firstChild[node] + c, flags);
+        }
+    }
+}
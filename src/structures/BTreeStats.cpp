@@ -0,0 +1,22 @@
+#include "../../include/structures/BTreeStats.h"
+
+BTreeStats& BTreeStats::global() {
+    static BTreeStats stats;
+    return stats;
+}
+
+BTreeStatsSnapshot BTreeStats::read() const {
+    BTreeStatsSnapshot snapshot;
+    snapshot.nodeVisits = nodeVisits.load(std::memory_order_relaxed);
+    snapshot.nodeAllocations = nodeAllocations.load(std::memory_order_relaxed);
+    snapshot.postingsDecoded = postingsDecoded.load(std::memory_order_relaxed);
+    snapshot.journalRecords = journalRecords.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void BTreeStats::reset() {
+    nodeVisits.store(0, std::memory_order_relaxed);
+    nodeAllocations.store(0, std::memory_order_relaxed);
+    postingsDecoded.store(0, std::memory_order_relaxed);
+    journalRecords.store(0, std::memory_order_relaxed);
+}
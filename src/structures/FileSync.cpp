@@ -0,0 +1,95 @@
+#include "../../include/structures/FileSync.h"
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define FILESYNC_POSIX 1
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace {
+
+#ifdef FILESYNC_POSIX
+bool syncPath(const std::string& path, int flags) {
+    int fd = ::open(path.c_str(), flags);
+    if (fd < 0) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+#endif
+
+} // namespace
+
+bool syncFile(const std::string& path) {
+#if defined(FILESYNC_POSIX)
+    return syncPath(path, O_RDONLY);
+#elif defined(_WIN32)
+    int fd = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) return false;
+    bool ok = _commit(fd) == 0;
+    _close(fd);
+    return ok;
+#else
+    (void)path;
+    return true;
+#endif
+}
+
+bool syncParentDirectory(const std::string& path) {
+#ifdef FILESYNC_POSIX
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    return syncPath(parent.empty() ? "." : parent.string(), O_RDONLY | O_DIRECTORY);
+#else
+    // Não há fsync de diretórios fora de POSIX; o rename fica a cargo do
+    // journal do próprio sistema de arquivos.
+    (void)path;
+    return true;
+#endif
+}
+
+bool syncStream(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#if defined(FILESYNC_POSIX)
+    return ::fsync(fileno(file)) == 0;
+#elif defined(_WIN32)
+    return _commit(_fileno(file)) == 0;
+#else
+    return true;
+#endif
+}
+
+std::string tempPathFor(const std::string& filename) {
+    return filename + ".tmp";
+}
+
+bool commitFile(const std::string& tempFile, const std::string& filename) {
+    // O conteúdo precisa estar no disco antes do rename; senão, após uma
+    // queda de energia, o nome novo pode apontar para um arquivo vazio.
+    if (!syncFile(tempFile)) {
+        std::cerr << "Erro: Nao foi possivel gravar no disco: " << tempFile << std::endl;
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    // rename substitui o destino de forma atômica: quem abrir o arquivo vê
+    // a versão antiga completa ou a nova completa.
+    std::error_code ec;
+    std::filesystem::rename(tempFile, filename, ec);
+    if (ec) {
+        std::cerr << "Erro: Nao foi possivel substituir o arquivo: " << filename << std::endl;
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    // Só com o diretório gravado o rename sobrevive a uma queda; até lá
+    // quem chama (ex.: checkpoint) não pode descartar a versão anterior.
+    if (!syncParentDirectory(filename)) {
+        std::cerr << "Erro: Nao foi possivel gravar o diretorio de: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,117 @@
+#include "../../include/structures/KeySearch.h"
+#include <string>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define KEYSEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Todas as variantes contam as chaves < target em [begin, end), com begin e
+// end múltiplos de LANES.
+typedef int (*CountLessFn)(const int32_t* keys, int begin, int end, int target);
+
+int countLessScalar(const int32_t* keys, int begin, int end, int target) {
+    int count = 0;
+    for (int i = begin; i < end; ++i) {
+        count += keys[i] < target ? 1 : 0;
+    }
+    return count;
+}
+
+#ifdef KEYSEARCH_X86
+__attribute__((target("sse2")))
+int countLessSse2(const int32_t* keys, int begin, int end, int target) {
+    __m128i needle = _mm_set1_epi32(target);
+    int count = 0;
+    for (int i = begin; i < end; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(keys + i));
+        __m128i less = _mm_cmpgt_epi32(needle, block);
+        count += __builtin_popcount((unsigned)_mm_movemask_ps(_mm_castsi128_ps(less)));
+    }
+    return count;
+}
+
+__attribute__((target("avx2")))
+int countLessAvx2(const int32_t* keys, int begin, int end, int target) {
+    __m256i needle = _mm256_set1_epi32(target);
+    int count = 0;
+    for (int i = begin; i < end; i += 8) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(keys + i));
+        __m256i less = _mm256_cmpgt_epi32(needle, block);
+        count += __builtin_popcount((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(less)));
+    }
+    return count;
+}
+#endif
+
+struct Implementation {
+    CountLessFn countLess;
+    const char* name;
+};
+
+Implementation chooseImplementation() {
+#ifdef KEYSEARCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {countLessAvx2, "avx2"};
+    if (__builtin_cpu_supports("sse2")) return {countLessSse2, "sse2"};
+#endif
+    return {countLessScalar, "scalar"};
+}
+
+const Implementation& selected() {
+    static const Implementation implementation = chooseImplementation();
+    return implementation;
+}
+
+CountLessFn implementationNamed(const std::string& name) {
+    if (name == "scalar") return countLessScalar;
+#ifdef KEYSEARCH_X86
+    __builtin_cpu_init();
+    if (name == "sse2" && __builtin_cpu_supports("sse2")) return countLessSse2;
+    if (name == "avx2" && __builtin_cpu_supports("avx2")) return countLessAvx2;
+#endif
+    return nullptr;
+}
+
+int lowerBoundUsing(CountLessFn countLess, const int32_t* keys, int count, int target) {
+    // Em nós grandes, uma busca binária reduz o trecho a poucos blocos
+    // antes da contagem vetorizada.
+    int lo = 0;
+    int hi = count;
+    while (hi - lo > 8 * KeySearch::LANES) {
+        int mid = lo + (hi - lo) / 2;
+        if (keys[mid] < target) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    // Tudo antes de lo é < target e tudo a partir de hi é >= target
+    // (chaves reais ou o preenchimento INT32_MAX), então contar em blocos
+    // alinhados que cobrem [lo, hi) dá a posição exata.
+    int begin = lo / KeySearch::LANES * KeySearch::LANES;
+    int end = KeySearch::paddedCount(hi);
+    return begin + countLess(keys, begin, end, target);
+}
+
+} // namespace
+
+int KeySearch::paddedCount(int count) {
+    return (count + LANES - 1) / LANES * LANES;
+}
+
+int KeySearch::lowerBound(const int32_t* keys, int count, int target) {
+    return lowerBoundUsing(selected().countLess, keys, count, target);
+}
+
+const char* KeySearch::implementationName() {
+    return selected().name;
+}
+
+int KeySearch::lowerBoundWith(const char* implementation, const int32_t* keys, int count, int target) {
+    CountLessFn countLess = implementationNamed(implementation);
+    if (!countLess) return -1;
+    return lowerBoundUsing(countLess, keys, count, target);
+}
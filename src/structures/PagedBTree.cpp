@@ -0,0 +1,161 @@
+#include "../../include/structures/PagedBTree.h"
+#include "../../include/structures/KeySearch.h"
+#include "../../include/structures/BTreeStats.h"
+#include <cstring>
+#include <iostream>
+
+PagedNodeLayout PagedNodeLayout::forDegree(int minDegree) {
+    PagedNodeLayout layout;
+    int maxKeys = 2 * minDegree - 1;
+    layout.keySlots = KeySearch::paddedCount(maxKeys);
+    // O cabeçalho ocupa 32 bytes para as chaves começarem alinhadas a AVX2.
+    layout.countsOffset = 32;
+    layout.lengthsOffset = layout.countsOffset + layout.keySlots * sizeof(int32_t);
+    layout.postingOffsetsOffset = layout.lengthsOffset + layout.keySlots * sizeof(uint32_t);
+    layout.childrenOffset = layout.postingOffsetsOffset + layout.keySlots * sizeof(uint64_t);
+    uint32_t bytes = layout.childrenOffset + (maxKeys + 1) * sizeof(uint64_t);
+    layout.pageSize = (bytes + 63) / 64 * 64;
+    return layout;
+}
+
+PagedBTree::PagedBTree() {
+    std::memset(&header, 0, sizeof(header));
+    std::memset(&layout, 0, sizeof(layout));
+}
+
+bool PagedBTree::open(const std::string& filename) {
+    close();
+    if (!file.open(filename)) {
+        return false;
+    }
+    if (file.size() < sizeof(PagedFileHeader)) {
+        std::cerr << "Erro: Arquivo paginado truncado: " << filename << std::endl;
+        close();
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.minDegree >= 2) {
+        layout = PagedNodeLayout::forDegree(header.minDegree);
+    }
+    if (header.magic != MAGIC || header.version != VERSION || header.minDegree < 2 ||
+        header.pageSize != layout.pageSize ||
+        header.postingsOffset > file.size() ||
+        header.postingsOffset < (header.nodeCount + 1) * header.pageSize) {
+        std::cerr << "Erro: Arquivo paginado invalido: " << filename << std::endl;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void PagedBTree::close() {
+    file.close();
+    std::memset(&header, 0, sizeof(header));
+    std::memset(&layout, 0, sizeof(layout));
+}
+
+std::vector<int> PagedBTree::search(int achievementCount) const {
+    std::vector<int> result;
+    uint64_t offset = header.rootOffset;
+    while (offset != 0) {
+        const PagedNodeHeader* node = nodeAt(offset);
+        if (!node) break;
+        int i = findKey(node, achievementCount);
+        if (i < node->keyCount && countsOf(node)[i] == achievementCount) {
+            appendPosting(node, i, result);
+            break;
+        }
+        if (node->isLeaf) break;
+        offset = childOffset(node, offset, i);
+    }
+    return result;
+}
+
+std::vector<int> PagedBTree::searchRange(int minCount, int maxCount) const {
+    std::vector<int> result;
+    if (header.rootOffset != 0) {
+        searchRangeNode(header.rootOffset, minCount, maxCount, result);
+    }
+    return result;
+}
+
+int PagedBTree::getMinDegree() const {
+    return header.minDegree;
+}
+
+uint64_t PagedBTree::getNodeCount() const {
+    return header.nodeCount;
+}
+
+const PagedNodeHeader* PagedBTree::nodeAt(uint64_t offset) const {
+    // Nós só podem estar entre o cabeçalho e a área de playerIds.
+    if (offset < header.pageSize || offset + header.pageSize > header.postingsOffset ||
+        offset % header.pageSize != 0) {
+        std::cerr << "Erro: Offset de pagina invalido: " << offset << std::endl;
+        return nullptr;
+    }
+    const PagedNodeHeader* node = (const PagedNodeHeader*)(file.data() + offset);
+    if (node->keyCount < 0 || node->keyCount > 2 * header.minDegree - 1) {
+        std::cerr << "Erro: Pagina de no corrompida: " << offset << std::endl;
+        return nullptr;
+    }
+    BTREE_STAT_ADD(nodeVisits, 1);
+    return node;
+}
+
+const int32_t* PagedBTree::countsOf(const PagedNodeHeader* node) const {
+    return (const int32_t*)((const char*)node + layout.countsOffset);
+}
+
+const uint64_t* PagedBTree::childrenOf(const PagedNodeHeader* node) const {
+    return (const uint64_t*)((const char*)node + layout.childrenOffset);
+}
+
+uint64_t PagedBTree::childOffset(const PagedNodeHeader* node, uint64_t offset, int index) const {
+    uint64_t child = childrenOf(node)[index];
+    if (child <= offset) {
+        std::cerr << "Erro: Filho fora da ordem das paginas: " << child << std::endl;
+        return 0;
+    }
+    return child;
+}
+
+int PagedBTree::findKey(const PagedNodeHeader* node, int achievementCount) const {
+    return KeySearch::lowerBound(countsOf(node), node->keyCount, achievementCount);
+}
+
+void PagedBTree::appendPosting(const PagedNodeHeader* node, int index, std::vector<int>& result) const {
+    const char* page = (const char*)node;
+    uint32_t length = ((const uint32_t*)(page + layout.lengthsOffset))[index];
+    uint64_t offset = ((const uint64_t*)(page + layout.postingOffsetsOffset))[index];
+    uint64_t bytes = (uint64_t)length * sizeof(int);
+    if (offset < header.postingsOffset || offset + bytes > file.size()) {
+        std::cerr << "Erro: Lista de jogadores fora do arquivo." << std::endl;
+        return;
+    }
+    size_t oldSize = result.size();
+    result.resize(oldSize + length);
+    if (bytes > 0) {
+        std::memcpy(result.data() + oldSize, file.data() + offset, bytes);
+    }
+}
+
+void PagedBTree::searchRangeNode(uint64_t offset, int minCount, int maxCount, std::vector<int>& result) const {
+    const PagedNodeHeader* node = nodeAt(offset);
+    if (!node) return;
+    const int32_t* counts = countsOf(node);
+    // Pula direto para a primeira chave >= minCount; as subárvores à
+    // esquerda dela não podem conter valores do intervalo.
+    int i = findKey(node, minCount);
+    for (; i <= node->keyCount; ++i) {
+        if (!node->isLeaf) {
+            uint64_t child = childOffset(node, offset, i);
+            if (child == 0) return;
+            searchRangeNode(child, minCount, maxCount, result);
+        }
+        if (i == node->keyCount || counts[i] > maxCount) {
+            return;
+        }
+        appendPosting(node, i, result);
+    }
+}
@@ -0,0 +1,31 @@
+#include "../../include/structures/Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+int resolveThreadCount(int threadCount) {
+    if (threadCount > 0) return threadCount;
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 0 ? (int)cores : 1;
+}
+
+void parallelFor(size_t count, int threads, const std::function<void(size_t)>& work) {
+    size_t workers = std::min(count, (size_t)std::max(threads, 1));
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) work(i);
+        return;
+    }
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> pool;
+    for (size_t w = 0; w < workers; ++w) {
+        pool.emplace_back([&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                work(i);
+            }
+        });
+    }
+    for (std::thread& thread : pool) {
+        thread.join();
+    }
+}
@@ -0,0 +1,201 @@
+#include "../../include/structures/PostingList.h"
+#include <algorithm>
+
+namespace {
+
+void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+// Lê um varint; retorna false se os bytes acabarem antes do fim do número.
+bool readVarint(const uint8_t* data, size_t length, size_t& pos, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= length) return false;
+        uint8_t byte = data[pos++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Zigzag permite gravar o primeiro id do bloco mesmo se for negativo.
+uint32_t zigzag(int value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+int unzigzag(uint32_t value) {
+    return (int)(value >> 1) ^ -(int)(value & 1);
+}
+
+} // namespace
+
+PostingList::PostingList() : count(0) {}
+
+PostingList PostingList::encode(const std::vector<int>& playerIds) {
+    std::vector<int> sorted(playerIds);
+    std::sort(sorted.begin(), sorted.end());
+
+    PostingList list;
+    list.count = (uint32_t)sorted.size();
+    list.bytes.reserve(sorted.size() + 8);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (i % BLOCK_SIZE == 0) {
+            list.skips.push_back({sorted[i], list.bytes.size()});
+            writeVarint(list.bytes, zigzag(sorted[i]));
+        } else {
+            writeVarint(list.bytes, (uint32_t)sorted[i] - (uint32_t)sorted[i - 1]);
+        }
+    }
+    list.bytes.shrink_to_fit();
+    return list;
+}
+
+bool PostingList::fromBytes(const uint8_t* data, size_t length, uint32_t count, PostingList& out) {
+    out.bytes.assign(data, data + length);
+    out.count = count;
+    if (!out.rebuildSkips()) {
+        out = PostingList();
+        return false;
+    }
+    return true;
+}
+
+bool PostingList::decodeBytes(const uint8_t* data, size_t length, uint32_t count, std::vector<int>& out) {
+    // Cada varint ocupa ao menos um byte: uma contagem maior que os bytes é
+    // corrupção, e é recusada antes de virar uma alocação enorme.
+    if (count > length) {
+        return false;
+    }
+    size_t oldSize = out.size();
+    out.resize(oldSize + count);
+    int* dest = out.data() + oldSize;
+    size_t pos = 0;
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t raw;
+        if (!readVarint(data, length, pos, raw)) {
+            out.resize(oldSize);
+            return false;
+        }
+        // O primeiro id de cada bloco é absoluto; os demais são deltas.
+        value = (i % BLOCK_SIZE == 0) ? (uint32_t)unzigzag(raw) : value + raw;
+        dest[i] = (int)value;
+    }
+    if (pos != length) {
+        out.resize(oldSize);
+        return false;
+    }
+    return true;
+}
+
+bool PostingList::rebuildSkips() {
+    skips.clear();
+    size_t pos = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        size_t start = pos;
+        uint32_t raw;
+        if (!readVarint(bytes.data(), bytes.size(), pos, raw)) return false;
+        if (i % BLOCK_SIZE == 0) {
+            skips.push_back({unzigzag(raw), start});
+        }
+    }
+    return pos == bytes.size();
+}
+
+std::vector<int> PostingList::decode() const {
+    std::vector<int> out;
+    decodeInto(out);
+    return out;
+}
+
+void PostingList::decodeInto(std::vector<int>& out) const {
+    size_t oldSize = out.size();
+    out.resize(oldSize + count);
+    int* dest = out.data() + oldSize;
+    for (size_t b = 0; b < skips.size(); ++b) {
+        dest += decodeBlock(b, dest);
+    }
+}
+
+size_t PostingList::decodeBlock(size_t block, int* out) const {
+    size_t pos = skips[block].offset;
+    size_t n = std::min((size_t)count - block * BLOCK_SIZE, BLOCK_SIZE);
+    const uint8_t* data = bytes.data();
+    uint32_t raw;
+    readVarint(data, bytes.size(), pos, raw);
+    uint32_t value = (uint32_t)skips[block].firstValue;
+    out[0] = (int)value;
+    for (size_t i = 1; i < n; ++i) {
+        readVarint(data, bytes.size(), pos, raw);
+        value += raw;
+        out[i] = (int)value;
+    }
+    return n;
+}
+
+bool PostingList::contains(int playerId) const {
+    // Último bloco cujo primeiro id é <= playerId.
+    auto it = std::upper_bound(skips.begin(), skips.end(), playerId,
+                               [](int v, const Skip& s) { return v < s.firstValue; });
+    if (it == skips.begin()) return false;
+    size_t block = (size_t)(it - skips.begin()) - 1;
+    int buffer[BLOCK_SIZE];
+    size_t n = decodeBlock(block, buffer);
+    return std::binary_search(buffer, buffer + n, playerId);
+}
+
+std::vector<int> PostingList::intersect(const PostingList& a, const PostingList& b) {
+    std::vector<int> result;
+    // Percorre a lista menor inteira e salta blocos da maior.
+    const PostingList& small = a.count <= b.count ? a : b;
+    const PostingList& large = a.count <= b.count ? b : a;
+    if (small.count == 0 || large.count == 0) return result;
+
+    std::vector<int> probes = small.decode();
+    int buffer[BLOCK_SIZE];
+    size_t block = 0;
+    size_t loaded = (size_t)-1;
+    size_t n = 0;
+    size_t pos = 0;
+    for (int id : probes) {
+        // Só pula um bloco se o seguinte começar antes de id: com ids
+        // repetidos, uma sequência de "id" pode começar no fim deste bloco.
+        while (block + 1 < large.skips.size() && large.skips[block + 1].firstValue < id) {
+            ++block;
+        }
+        if (id < large.skips[block].firstValue) continue;
+        while (true) {
+            if (loaded != block) {
+                n = large.decodeBlock(block, buffer);
+                loaded = block;
+                pos = 0;
+            }
+            while (pos < n && buffer[pos] < id) ++pos;
+            // Bloco esgotado: a sequência pode continuar no próximo.
+            if (pos < n || block + 1 >= large.skips.size()) break;
+            ++block;
+        }
+        if (pos < n && buffer[pos] == id) {
+            result.push_back(id);
+            ++pos;
+        }
+    }
+    return result;
+}
+
+uint32_t PostingList::size() const {
+    return count;
+}
+
+bool PostingList::empty() const {
+    return count == 0;
+}
+
+const std::vector<uint8_t>& PostingList::getBytes() const {
+    return bytes;
+}
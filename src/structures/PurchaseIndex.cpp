@@ -0,0 +1,353 @@
+#include "../../include/structures/PurchaseIndex.h"
+#include "../../include/structures/FileSync.h"
+#include "../../include/structures/Parallel.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// Quantidade de compras processadas por tarefa nas etapas paralelas.
+const size_t CHUNK_SIZE = 1 << 16;
+
+size_t padTo8(size_t bytes) {
+    return (bytes + 7) / 8 * 8;
+}
+
+} // namespace
+
+PurchaseIndex::PurchaseIndex() {
+    clear();
+}
+
+void PurchaseIndex::build(const std::vector<PurchasedGame>& purchases, int threadCount) {
+    clear();
+    int threads = resolveThreadCount(threadCount);
+    buildAdjacency(purchases, true, threads, playerToGames);
+    buildAdjacency(purchases, false, threads, gameToPlayers);
+}
+
+void PurchaseIndex::buildAdjacency(const std::vector<PurchasedGame>& purchases, bool byPlayer,
+                                   int threads, Adjacency& out) {
+    size_t n = purchases.size();
+    auto source = [&](size_t i) {
+        return byPlayer ? purchases[i].getPlayerId() : purchases[i].getGameId();
+    };
+    auto target = [&](size_t i) {
+        return byPlayer ? purchases[i].getGameId() : purchases[i].getPlayerId();
+    };
+
+    // As compras são divididas em partes contíguas, uma por tarefa. Cada
+    // parte conta e distribui as suas compras sem disputar contadores com
+    // as outras, e a ordem de entrada é mantida dentro de cada linha.
+    size_t parts = std::max<size_t>(1, std::min<size_t>((size_t)threads, (n + CHUNK_SIZE - 1) / CHUNK_SIZE));
+    auto partBegin = [&](size_t p) { return n * p / parts; };
+
+    // 1. Faixa dos ids de origem.
+    std::vector<int> partMin(parts, INT_MAX);
+    std::vector<int> partMax(parts, INT_MIN);
+    parallelFor(parts, threads, [&](size_t p) {
+        for (size_t i = partBegin(p); i < partBegin(p + 1); ++i) {
+            partMin[p] = std::min(partMin[p], source(i));
+            partMax[p] = std::max(partMax[p], source(i));
+        }
+    });
+    int minId = *std::min_element(partMin.begin(), partMin.end());
+    int maxId = *std::max_element(partMax.begin(), partMax.end());
+
+    // 2. Posição ("slot") de cada compra nos histogramas. Ids densos, como
+    // os do dataset, usam id - minId direto; ids esparsos usam a posição na
+    // lista de ids distintos, montada por partes e intercalada.
+    size_t span = n == 0 ? 0 : (size_t)((int64_t)maxId - minId + 1);
+    bool dense = span <= n;
+    std::vector<int> sparseKeys;
+    if (!dense) {
+        std::vector<std::vector<int>> partKeys(parts);
+        parallelFor(parts, threads, [&](size_t p) {
+            std::vector<int>& ids = partKeys[p];
+            for (size_t i = partBegin(p); i < partBegin(p + 1); ++i) ids.push_back(source(i));
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        });
+        for (std::vector<int>& ids : partKeys) {
+            std::vector<int> merged;
+            merged.reserve(sparseKeys.size() + ids.size());
+            std::set_union(sparseKeys.begin(), sparseKeys.end(), ids.begin(), ids.end(), std::back_inserter(merged));
+            sparseKeys.swap(merged);
+            std::vector<int>().swap(ids);
+        }
+    }
+    size_t slotCount = dense ? span : sparseKeys.size();
+
+    // Os histogramas ocupam parts * slotCount contadores; com muitas linhas
+    // usa menos partes para não passar de dois contadores por compra.
+    if (slotCount > 0) {
+        parts = std::max<size_t>(1, std::min(parts, 2 * n / slotCount));
+    }
+
+    // 3. Histograma por parte: counts[p * slotCount + s] compras da parte p
+    // no slot s.
+    std::vector<uint32_t> slots(n);
+    std::vector<uint64_t> counts(parts * slotCount, 0);
+    parallelFor(parts, threads, [&](size_t p) {
+        uint64_t* partCounts = counts.data() + p * slotCount;
+        for (size_t i = partBegin(p); i < partBegin(p + 1); ++i) {
+            int id = source(i);
+            slots[i] = dense ? (uint32_t)((int64_t)id - minId)
+                             : (uint32_t)(std::lower_bound(sparseKeys.begin(), sparseKeys.end(), id) - sparseKeys.begin());
+            ++partCounts[slots[i]];
+        }
+    });
+
+    // 4. Soma de prefixos sobre (slot, parte): cada contador vira o cursor de
+    // escrita da parte naquela linha. Slots sem compras não viram linhas.
+    std::vector<int>& keys = out.ownedKeys;
+    std::vector<uint64_t>& offsets = out.ownedOffsets;
+    keys.clear();
+    offsets.assign(1, 0);
+    uint64_t total = 0;
+    for (size_t s = 0; s < slotCount; ++s) {
+        uint64_t rowStart = total;
+        for (size_t p = 0; p < parts; ++p) {
+            uint64_t count = counts[p * slotCount + s];
+            counts[p * slotCount + s] = total;
+            total += count;
+        }
+        if (total != rowStart) {
+            keys.push_back(dense ? (int)((int64_t)minId + (int64_t)s) : sparseKeys[s]);
+            offsets.push_back(total);
+        }
+    }
+    std::vector<int>().swap(sparseKeys);
+    size_t rowCount = keys.size();
+
+    // 5. Distribuição: cada parte escreve nas suas posições reservadas.
+    std::vector<int>& neighbors = out.ownedNeighbors;
+    neighbors.resize(n);
+    parallelFor(parts, threads, [&](size_t p) {
+        uint64_t* cursors = counts.data() + p * slotCount;
+        for (size_t i = partBegin(p); i < partBegin(p + 1); ++i) {
+            neighbors[cursors[slots[i]]++] = target(i);
+        }
+    });
+    std::vector<uint64_t>().swap(counts);
+    std::vector<uint32_t>().swap(slots);
+
+    // 6. Ordena cada linha (só se preciso) e remove compras repetidas.
+    std::vector<uint64_t> uniqueCounts(rowCount);
+    size_t rowChunks = (rowCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    parallelFor(rowChunks, threads, [&](size_t c) {
+        size_t end = std::min(rowCount, (c + 1) * CHUNK_SIZE);
+        for (size_t r = c * CHUNK_SIZE; r < end; ++r) {
+            int* first = neighbors.data() + offsets[r];
+            int* last = neighbors.data() + offsets[r + 1];
+            if (!std::is_sorted(first, last)) std::sort(first, last);
+            uniqueCounts[r] = (uint64_t)(std::unique(first, last) - first);
+        }
+    });
+
+    // 7. Compacta as linhas para remover os buracos deixados pelas repetições.
+    uint64_t write = 0;
+    for (size_t r = 0; r < rowCount; ++r) {
+        uint64_t read = offsets[r];
+        if (write != read) {
+            std::memmove(neighbors.data() + write, neighbors.data() + read, uniqueCounts[r] * sizeof(int));
+        }
+        offsets[r] = write;
+        write += uniqueCounts[r];
+    }
+    offsets[rowCount] = write;
+    keys.shrink_to_fit();
+    offsets.shrink_to_fit();
+    neighbors.resize(write);
+    neighbors.shrink_to_fit();
+
+    out.keyCount = rowCount;
+    out.edgeCount = write;
+    out.pointToOwned();
+}
+
+void PurchaseIndex::Adjacency::pointToOwned() {
+    keys = ownedKeys.data();
+    offsets = ownedOffsets.data();
+    neighbors = ownedNeighbors.data();
+}
+
+IdSpan PurchaseIndex::Adjacency::row(int key) const {
+    IdSpan span;
+    const int* end = keys + keyCount;
+    const int* it = std::lower_bound(keys, end, key);
+    if (it == end || *it != key) return span;
+    size_t r = (size_t)(it - keys);
+    // openFile confere só o último offset; um do meio corrompido é
+    // descoberto aqui, a custo O(1), e a linha sai vazia.
+    if (offsets[r] > offsets[r + 1] || offsets[r + 1] > edgeCount) return span;
+    span.data = neighbors + offsets[r];
+    span.count = (size_t)(offsets[r + 1] - offsets[r]);
+    return span;
+}
+
+IdSpan PurchaseIndex::gamesOf(int playerId) const {
+    return playerToGames.row(playerId);
+}
+
+IdSpan PurchaseIndex::ownersOf(int gameId) const {
+    return gameToPlayers.row(gameId);
+}
+
+bool PurchaseIndex::owns(int playerId, int gameId) const {
+    IdSpan games = gamesOf(playerId);
+    return std::binary_search(games.begin(), games.end(), gameId);
+}
+
+std::vector<int> PurchaseIndex::sharedGames(int playerA, int playerB) const {
+    return intersect(gamesOf(playerA), gamesOf(playerB));
+}
+
+std::vector<int> PurchaseIndex::commonOwners(int gameA, int gameB) const {
+    return intersect(ownersOf(gameA), ownersOf(gameB));
+}
+
+std::vector<int> PurchaseIndex::intersect(IdSpan a, IdSpan b) {
+    if (a.size() > b.size()) std::swap(a, b);
+    std::vector<int> result;
+    if (a.empty()) return result;
+    result.reserve(a.size());
+
+    if (b.size() / a.size() < 32) {
+        // Tamanhos parecidos: merge linear.
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(result));
+        return result;
+    }
+
+    // Uma lista muito menor: para cada id, busca exponencial a partir da
+    // última posição encontrada na maior.
+    const int* pos = b.begin();
+    for (int id : a) {
+        size_t step = 1;
+        const int* hi = pos;
+        while (hi < b.end() && *hi < id) {
+            pos = hi;
+            hi = (size_t)(b.end() - hi) > step ? hi + step : b.end();
+            step *= 2;
+        }
+        pos = std::lower_bound(pos, hi, id);
+        if (pos == b.end()) break;
+        if (*pos == id) {
+            result.push_back(id);
+            ++pos;
+        }
+    }
+    return result;
+}
+
+size_t PurchaseIndex::getPlayerCount() const {
+    return playerToGames.keyCount;
+}
+
+size_t PurchaseIndex::getGameCount() const {
+    return gameToPlayers.keyCount;
+}
+
+size_t PurchaseIndex::getPurchaseCount() const {
+    return playerToGames.edgeCount;
+}
+
+void PurchaseIndex::clear() {
+    file.close();
+    for (Adjacency* adjacency : {&playerToGames, &gameToPlayers}) {
+        adjacency->ownedKeys.clear();
+        adjacency->ownedNeighbors.clear();
+        adjacency->ownedOffsets.assign(1, 0); // Índice vazio: uma linha de fim.
+        adjacency->keyCount = 0;
+        adjacency->edgeCount = 0;
+        adjacency->pointToOwned();
+    }
+}
+
+size_t PurchaseIndex::sectionBytes(uint64_t keyCount, uint64_t edgeCount) {
+    return padTo8(keyCount * sizeof(int)) + (keyCount + 1) * sizeof(uint64_t) + padTo8(edgeCount * sizeof(int));
+}
+
+void PurchaseIndex::writeAdjacency(std::ofstream& out, const Adjacency& adjacency) {
+    static const char zeros[8] = {0};
+    size_t keyBytes = adjacency.keyCount * sizeof(int);
+    size_t edgeBytes = adjacency.edgeCount * sizeof(int);
+    out.write((const char*)adjacency.keys, keyBytes);
+    out.write(zeros, padTo8(keyBytes) - keyBytes);
+    out.write((const char*)adjacency.offsets, (adjacency.keyCount + 1) * sizeof(uint64_t));
+    out.write((const char*)adjacency.neighbors, edgeBytes);
+    out.write(zeros, padTo8(edgeBytes) - edgeBytes);
+}
+
+bool PurchaseIndex::saveToFile(const std::string& filename) const {
+    std::string tempFile = tempPathFor(filename);
+    std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Erro: Nao foi possivel abrir o arquivo para escrita: " << filename << std::endl;
+        return false;
+    }
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.playerKeyCount = playerToGames.keyCount;
+    header.playerEdgeCount = playerToGames.edgeCount;
+    header.gameKeyCount = gameToPlayers.keyCount;
+    header.gameEdgeCount = gameToPlayers.edgeCount;
+    out.write((const char*)&header, sizeof(header));
+    writeAdjacency(out, playerToGames);
+    writeAdjacency(out, gameToPlayers);
+    out.close();
+    if (!out) {
+        std::cerr << "Erro: Falha ao escrever o indice de compras: " << filename << std::endl;
+        std::remove(tempFile.c_str());
+        return false;
+    }
+    return commitFile(tempFile, filename);
+}
+
+const char* PurchaseIndex::mapAdjacency(const char* cursor, uint64_t keyCount, uint64_t edgeCount,
+                                        Adjacency& adjacency) {
+    adjacency.keys = (const int*)cursor;
+    cursor += padTo8(keyCount * sizeof(int));
+    adjacency.offsets = (const uint64_t*)cursor;
+    cursor += (keyCount + 1) * sizeof(uint64_t);
+    adjacency.neighbors = (const int*)cursor;
+    cursor += padTo8(edgeCount * sizeof(int));
+    adjacency.keyCount = keyCount;
+    adjacency.edgeCount = edgeCount;
+    return cursor;
+}
+
+bool PurchaseIndex::openFile(const std::string& filename) {
+    clear();
+    if (!file.open(filename)) {
+        return false;
+    }
+    FileHeader header;
+    bool valid = file.size() >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, file.data(), sizeof(header));
+        valid = header.magic == MAGIC && header.version == VERSION &&
+                file.size() == sizeof(header) + sectionBytes(header.playerKeyCount, header.playerEdgeCount)
+                                              + sectionBytes(header.gameKeyCount, header.gameEdgeCount);
+    }
+    if (valid) {
+        const char* cursor = file.data() + sizeof(header);
+        cursor = mapAdjacency(cursor, header.playerKeyCount, header.playerEdgeCount, playerToGames);
+        mapAdjacency(cursor, header.gameKeyCount, header.gameEdgeCount, gameToPlayers);
+        // Só o fim de cada CSR é conferido; abrir continua O(1).
+        valid = playerToGames.offsets[playerToGames.keyCount] == playerToGames.edgeCount &&
+                gameToPlayers.offsets[gameToPlayers.keyCount] == gameToPlayers.edgeCount;
+    }
+    if (!valid) {
+        std::cerr << "Erro: Indice de compras invalido: " << filename << std::endl;
+        clear();
+        return false;
+    }
+    return true;
+}
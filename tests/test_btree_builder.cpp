@@ -0,0 +1,167 @@
+#include "BTree.h"
+#include "BTreeBuilder.h"
+#include "BTreePersistence.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Testes do BTreeBuilder: a árvore montada em lote precisa respeitar as
+// invariantes da Árvore B para qualquer grau e fator de ocupação.
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& description) {
+    if (!condition) {
+        std::cerr << "FALHOU: " << description << std::endl;
+        ++failures;
+    }
+}
+
+// Árvore lida do arquivo no formato original (grau + nós em pré-ordem).
+struct ParsedTree {
+    int minDegree = 0;
+    size_t nodes = 0;
+    size_t leaves = 0;
+    int leafDepth = -1;
+    bool balanced = true;
+    bool degreeOk = true;
+    std::vector<int> counts;  // Chaves em ordem simétrica.
+    std::vector<int> players; // playerIds na mesma ordem.
+};
+
+static bool parseNode(std::istream& in, ParsedTree& tree, int depth, bool isRoot) {
+    int n = 0;
+    bool leaf = false;
+    in.read((char*)&n, sizeof(int));
+    in.read((char*)&leaf, sizeof(bool));
+    if (!in) return false;
+    ++tree.nodes;
+    int t = tree.minDegree;
+    if (n > 2 * t - 1 || (!isRoot && n < t - 1) || n < 1) {
+        tree.degreeOk = false;
+    }
+    std::vector<int> keyCounts(n);
+    std::vector<std::vector<int>> keyPlayers(n);
+    for (int i = 0; i < n; ++i) {
+        size_t size = 0;
+        in.read((char*)&keyCounts[i], sizeof(int));
+        in.read((char*)&size, sizeof(size_t));
+        keyPlayers[i].resize(size);
+        in.read((char*)keyPlayers[i].data(), size * sizeof(int));
+    }
+    if (leaf) {
+        ++tree.leaves;
+        if (tree.leafDepth == -1) tree.leafDepth = depth;
+        if (tree.leafDepth != depth) tree.balanced = false;
+    }
+    for (int i = 0; i <= n; ++i) {
+        if (!leaf && !parseNode(in, tree, depth + 1, false)) return false;
+        if (i < n) {
+            tree.counts.push_back(keyCounts[i]);
+            tree.players.insert(tree.players.end(), keyPlayers[i].begin(), keyPlayers[i].end());
+        }
+    }
+    return true;
+}
+
+static bool parseFile(const std::string& filename, ParsedTree& tree) {
+    std::ifstream in(filename, std::ios::binary);
+    in.read((char*)&tree.minDegree, sizeof(int));
+    if (!in) return false;
+    if (in.peek() == std::ifstream::traits_type::eof()) return true; // Árvore vazia.
+    return parseNode(in, tree, 0, true) && in.peek() == std::ifstream::traits_type::eof();
+}
+
+static void testInvariants(int t, double fillFactor, int keyCount) {
+    std::string name = "t=" + std::to_string(t) + " fill=" + std::to_string(fillFactor) +
+                       " chaves=" + std::to_string(keyCount);
+    const std::string file = "builder_test.dat";
+
+    BTreeBuilder builder(t, fillFactor);
+    std::vector<int> expectedCounts;
+    std::vector<int> expectedPlayers;
+    int player = 0;
+    for (int k = 0; k < keyCount; ++k) {
+        // Algumas chaves com mais de um jogador, como contagens repetidas.
+        int repeats = 1 + k % 3;
+        for (int r = 0; r < repeats; ++r) {
+            check(builder.add(k * 2, player), name + ": add em ordem");
+            expectedPlayers.push_back(player++);
+        }
+        expectedCounts.push_back(k * 2);
+    }
+    if (keyCount > 0) {
+        check(!builder.add(-1, 0), name + ": add fora de ordem rejeitado");
+    }
+
+    BTreeSaveOptions options;
+    check(BTreePersistence::saveBuiltToFile(builder, file, options), name + ": saveBuiltToFile");
+    check(builder.getKeyCount() == (size_t)keyCount, name + ": getKeyCount");
+
+    ParsedTree tree;
+    check(parseFile(file, tree), name + ": arquivo legível");
+    check(tree.minDegree == t, name + ": grau gravado");
+    check(tree.degreeOk, name + ": chaves por nó entre t-1 e 2t-1");
+    check(tree.balanced, name + ": folhas na mesma profundidade");
+    check(tree.nodes == builder.getNodeCount(), name + ": getNodeCount");
+    check(tree.counts == expectedCounts, name + ": chaves em ordem");
+    check(tree.players == expectedPlayers, name + ": playerIds preservados");
+
+    // Com ocupação total as folhas saem cheias: P folhas guardam
+    // P*(2t-1) chaves mais P-1 separadores, logo P = ceil((N+1) / 2t).
+    if (fillFactor >= 1.0 && keyCount > 0) {
+        size_t packed = ((size_t)keyCount + 2 * t) / (2 * t);
+        check(tree.leaves == packed, name + ": folhas cheias com fillFactor 1.0");
+    }
+    std::remove(file.c_str());
+}
+
+static void testFillFactorOrdering() {
+    // Menos ocupação nunca gera menos nós.
+    size_t previous = 0;
+    for (double fill : {1.0, 0.75, 0.5, 0.0}) {
+        BTreeBuilder builder(8, fill);
+        for (int k = 0; k < 5000; ++k) {
+            builder.add(k, k);
+        }
+        builder.build();
+        check(builder.getNodeCount() >= previous, "fillFactor menor gera mais nós");
+        previous = builder.getNodeCount();
+    }
+}
+
+static void testBuildTreeMatchesInserts() {
+    BTreeBuilder builder(3, 0.7);
+    BTree inserted(3);
+    for (int k = 0; k < 2000; ++k) {
+        builder.add(k / 4, k);
+        inserted.insert(k / 4, k);
+    }
+    BTree* built = BTreePersistence::buildTree(builder);
+    check(built->searchRange(0, 1000) == inserted.searchRange(0, 1000), "buildTree igual às inserções");
+    check(built->search(123) == inserted.search(123), "buildTree: busca pontual");
+    built->insert(10000, 1);
+    check(built->search(10000).size() == 1, "buildTree aceita inserções depois");
+    delete built;
+}
+
+int main() {
+    for (int t : {2, 3, 16}) {
+        for (double fill : {0.0, 0.5, 0.9, 1.0}) {
+            for (int keys : {0, 1, 2 * t - 1, 2 * t, 2 * t * 2 * t, 1000, 10007}) {
+                testInvariants(t, fill, keys);
+            }
+        }
+    }
+    testFillFactorOrdering();
+    testBuildTreeMatchesInserts();
+
+    if (failures > 0) {
+        std::cerr << failures << " verificacoes falharam." << std::endl;
+        return 1;
+    }
+    std::cout << "Todos os testes do BTreeBuilder passaram." << std::endl;
+    return 0;
+}
@@ -0,0 +1,303 @@
+#include "BTree.h"
+#include "BTreeBuilder.h"
+#include "BTreeJournal.h"
+#include "BTreePersistence.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Testes do write-ahead log: recuperação depois de quedas em cada ponto
+// do ciclo log -> checkpoint -> truncate, sem perder nem duplicar operações.
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& description) {
+    if (!condition) {
+        std::cerr << "FALHOU: " << description << std::endl;
+        ++failures;
+    }
+}
+
+static const std::string SNAPSHOT = "journal_test.dat";
+static const int DEGREE = 3;
+
+static void removeFiles() {
+    std::remove(SNAPSHOT.c_str());
+    std::remove(BTreeJournal::pathFor(SNAPSHOT).c_str());
+    std::remove((SNAPSHOT + ".tmp").c_str());
+}
+
+static std::vector<int> allIds(BTree* tree) {
+    std::vector<int> ids = tree->searchRange(INT_MIN, INT_MAX);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Carrega snapshot + log como na abertura do programa.
+static std::vector<int> reloadIds() {
+    BTree* tree = BTreePersistence::loadFromFile(SNAPSHOT);
+    if (!tree) return {-1};
+    std::vector<int> ids = allIds(tree);
+    delete tree;
+    return ids;
+}
+
+static std::vector<int> range(int first, int last) {
+    std::vector<int> ids;
+    for (int id = first; id < last; ++id) {
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+static void insertLogged(BTree& tree, BTreeJournal& journal, int first, int last) {
+    for (int id = first; id < last; ++id) {
+        tree.insert(id % 7, id);
+        journal.logInsert(id % 7, id);
+    }
+}
+
+static void testTornTail() {
+    removeFiles();
+    {
+        BTree tree(DEGREE);
+        BTreeJournal journal;
+        check(journal.open(SNAPSHOT, DEGREE), "torn tail: open");
+        insertLogged(tree, journal, 0, 50);
+        check(journal.flush(), "torn tail: flush");
+    }
+    std::string log = BTreeJournal::pathFor(SNAPSHOT);
+    uintmax_t validSize = std::filesystem::file_size(log);
+    {
+        // Metade de um registro, como um processo morto no meio do write.
+        std::ofstream out(log, std::ios::binary | std::ios::app);
+        const char partial[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        out.write(partial, sizeof(partial));
+    }
+    check(reloadIds() == range(0, 50), "torn tail: carga ignora o registro incompleto");
+
+    BTreeJournal journal;
+    check(journal.open(SNAPSHOT, DEGREE), "torn tail: reabre");
+    check(std::filesystem::file_size(log) == validSize, "torn tail: final cortado na abertura");
+    check(journal.getLastLsn() == 50, "torn tail: LSN continua do último registro válido");
+    journal.logInsert(1, 50);
+    check(journal.flush(), "torn tail: flush depois do reparo");
+    check(reloadIds() == range(0, 51), "torn tail: registro novo é reaplicado");
+    journal.close();
+    removeFiles();
+}
+
+static void testCrashBeforeTruncate() {
+    removeFiles();
+    BTree tree(DEGREE);
+    BTreeJournal journal;
+    check(journal.open(SNAPSHOT, DEGREE), "snapshot sem truncate: open");
+    insertLogged(tree, journal, 0, 80);
+    check(journal.flush(), "snapshot sem truncate: flush");
+
+    // Guarda o log como estava antes do checkpoint e o devolve depois:
+    // é o estado de uma queda entre gravar o snapshot e esvaziar o log.
+    std::string log = BTreeJournal::pathFor(SNAPSHOT);
+    std::string saved = log + ".copy";
+    std::filesystem::copy_file(log, saved, std::filesystem::copy_options::overwrite_existing);
+    check(BTreePersistence::checkpoint(&tree, SNAPSHOT, journal), "snapshot sem truncate: checkpoint");
+    journal.close();
+    std::filesystem::copy_file(saved, log, std::filesystem::copy_options::overwrite_existing);
+    std::remove(saved.c_str());
+
+    check(BTreePersistence::readCheckpointLsn(SNAPSHOT) == 80, "snapshot sem truncate: LSN no snapshot");
+    check(reloadIds() == range(0, 80), "snapshot sem truncate: registros antigos não duplicam");
+
+    // Reabrir o log antigo não pode reutilizar LSNs já cobertos.
+    BTreeJournal reopened;
+    check(reopened.open(SNAPSHOT, DEGREE), "snapshot sem truncate: reabre");
+    check(reopened.getLastLsn() == 80, "snapshot sem truncate: LSN preservado");
+    check(reopened.getRecordCount() == 0, "snapshot sem truncate: nada pendente de checkpoint");
+    reopened.close();
+    removeFiles();
+}
+
+static void testReopenLsnContinuity() {
+    removeFiles();
+    BTree tree(DEGREE);
+    {
+        BTreeJournal journal;
+        check(journal.open(SNAPSHOT, DEGREE), "continuidade: open");
+        insertLogged(tree, journal, 0, 10);
+    } // O destrutor grava os pendentes.
+    {
+        BTreeJournal journal;
+        check(journal.open(SNAPSHOT, DEGREE), "continuidade: reabre");
+        check(journal.getLastLsn() == 10, "continuidade: LSN depois de reabrir");
+        check(journal.getRecordCount() == 10, "continuidade: registros desde o checkpoint");
+        insertLogged(tree, journal, 10, 15);
+        check(journal.getLastLsn() == 15, "continuidade: LSN segue crescendo");
+        check(BTreePersistence::checkpoint(&tree, SNAPSHOT, journal), "continuidade: checkpoint");
+        check(journal.getRecordCount() == 0, "continuidade: checkpoint zera a contagem");
+    }
+    {
+        // Log vazio após o checkpoint: o LSN vem do snapshot.
+        BTreeJournal journal;
+        check(journal.open(SNAPSHOT, DEGREE), "continuidade: reabre após checkpoint");
+        check(journal.getLastLsn() == 15, "continuidade: LSN lido do snapshot");
+        journal.logInsert(0, 15);
+        check(journal.getLastLsn() == 16, "continuidade: próximo LSN");
+    }
+    check(reloadIds() == range(0, 16), "continuidade: carga completa");
+
+    BTreeJournal wrongDegree;
+    check(!wrongDegree.open(SNAPSHOT, DEGREE + 1), "continuidade: grau diferente é recusado");
+    removeFiles();
+}
+
+static void testReplayAfterCheckpoint() {
+    removeFiles();
+    BTree tree(DEGREE);
+    BTreeJournal journal;
+    check(journal.open(SNAPSHOT, DEGREE), "replay: open");
+    insertLogged(tree, journal, 0, 100);
+    check(BTreePersistence::checkpoint(&tree, SNAPSHOT, journal), "replay: checkpoint");
+    insertLogged(tree, journal, 100, 130);
+    for (int id = 0; id < 20; ++id) {
+        tree.remove(id % 7, id);
+        journal.logRemove(id % 7, id);
+    }
+    check(journal.flush(), "replay: flush");
+
+    // Sem novo checkpoint: a carga parte do snapshot e reaplica só o resto.
+    check(reloadIds() == range(20, 130), "replay: inserções e remoções após o checkpoint");
+    check(reloadIds() == allIds(&tree), "replay: igual à árvore em memória");
+    journal.close();
+    removeFiles();
+}
+
+static void testPlainSaveRefused() {
+    removeFiles();
+    BTree tree(DEGREE);
+    BTreeJournal journal;
+    check(journal.open(SNAPSHOT, DEGREE), "save sem LSN: open");
+    insertLogged(tree, journal, 0, 40);
+    check(BTreePersistence::checkpoint(&tree, SNAPSHOT, journal), "save sem LSN: checkpoint");
+    insertLogged(tree, journal, 40, 60);
+    check(journal.flush(), "save sem LSN: flush");
+
+    // Gravado sem LSN, o snapshot já teria 0..59 e a carga reaplicaria
+    // 40..59 do log por cima: a gravação precisa ser recusada.
+    BTreePersistence::saveToFile(&tree, SNAPSHOT);
+    check(BTreePersistence::readCheckpointLsn(SNAPSHOT) == 40, "save sem LSN: snapshot anterior mantido");
+    check(reloadIds() == range(0, 60), "save sem LSN: nenhum id duplicado");
+
+    BTreeBuilder builder(DEGREE);
+    builder.add(1, 1000);
+    check(!BTreePersistence::saveBuiltToFile(builder, SNAPSHOT), "save sem LSN: saveBuiltToFile recusado");
+    check(reloadIds() == range(0, 60), "save sem LSN: builder não substitui o snapshot");
+
+    journal.close();
+    removeFiles();
+}
+
+static void testAsyncSnapshotWithLog() {
+    removeFiles();
+    BTree tree(DEGREE);
+    std::shared_mutex treeMutex;
+    BTreeJournal journal;
+    check(journal.open(SNAPSHOT, DEGREE), "snapshot async: open");
+    insertLogged(tree, journal, 0, 100);
+    check(BTreePersistence::checkpoint(&tree, SNAPSHOT, journal), "snapshot async: checkpoint");
+    insertLogged(tree, journal, 100, 120);
+    check(journal.flush(), "snapshot async: flush");
+
+    // Sem o journal o LSN não seria gravado: o snapshot é recusado.
+    SnapshotResult refused = BTreePersistence::saveSnapshotAsync(&tree, SNAPSHOT, treeMutex).get();
+    check(!refused.success, "snapshot async: recusado sem journal com log ao lado");
+
+    SnapshotResult result = BTreePersistence::saveSnapshotAsync(&tree, SNAPSHOT, treeMutex, journal).get();
+    check(result.success, "snapshot async: gravado");
+    check(result.bytesWritten == std::filesystem::file_size(SNAPSHOT), "snapshot async: bytesWritten");
+    check(BTreePersistence::readCheckpointLsn(SNAPSHOT) == 120, "snapshot async: LSN do journal");
+    check(reloadIds() == range(0, 120), "snapshot async: log não é reaplicado por cima");
+
+    insertLogged(tree, journal, 120, 125);
+    check(journal.flush(), "snapshot async: flush depois");
+    check(reloadIds() == range(0, 125), "snapshot async: registros posteriores reaplicados");
+    journal.close();
+    removeFiles();
+}
+
+static void testAsyncSnapshotConcurrentWriter() {
+    removeFiles();
+    const int initial = 100000;
+    const int degree = 32;
+    BTree tree(degree);
+    std::shared_mutex treeMutex;
+    BTreeJournal journal;
+    check(journal.open(SNAPSHOT, degree), "escritor concorrente: open");
+    // Muitas chaves distintas, para a codificação pesar mais que a cópia.
+    for (int id = 0; id < initial; ++id) {
+        tree.insert(id / 16, id);
+        journal.logInsert(id / 16, id);
+    }
+    check(BTreePersistence::checkpoint(&tree, SNAPSHOT, journal), "escritor concorrente: checkpoint");
+
+    // Um escritor insere enquanto o snapshot (com compressão) ainda está
+    // pendente; o lock exclusivo só pode esperar a cópia dos nós.
+    std::atomic<bool> pending(true);
+    std::atomic<int> next(initial);
+    std::thread writer([&]() {
+        while (pending.load()) {
+            {
+                std::unique_lock<std::shared_mutex> lock(treeMutex);
+                int id = next.load();
+                tree.insert(id / 16, id);
+                journal.logInsert(id / 16, id);
+                next.store(id + 1);
+            }
+            std::this_thread::yield(); // Sem monopolizar o lock num único núcleo.
+        }
+    });
+    BTreeSaveOptions options;
+    options.compressPostings = true;
+    std::future<SnapshotResult> future = BTreePersistence::saveSnapshotAsync(&tree, SNAPSHOT, treeMutex, journal,
+                                                                             options);
+    SnapshotResult result = future.get();
+    int insertedWhilePending = next.load() - initial;
+    pending.store(false);
+    writer.join();
+
+    check(result.success, "escritor concorrente: snapshot gravado");
+    check(insertedWhilePending > 0, "escritor concorrente: inserções durante o snapshot");
+    // A codificação (e o fsync) acontece fora do lock: a cópia é o trecho menor.
+    check(result.captureMillis < result.writeMillis, "escritor concorrente: lock só durante a cópia");
+
+    uint64_t lsn = BTreePersistence::readCheckpointLsn(SNAPSHOT);
+    check(lsn >= (uint64_t)initial && lsn <= (uint64_t)next.load(), "escritor concorrente: LSN da cópia");
+    check(journal.flush(), "escritor concorrente: flush");
+    check(reloadIds() == allIds(&tree), "escritor concorrente: snapshot + log igual à árvore");
+    journal.close();
+    removeFiles();
+}
+
+int main() {
+    testTornTail();
+    testCrashBeforeTruncate();
+    testReopenLsnContinuity();
+    testReplayAfterCheckpoint();
+    testPlainSaveRefused();
+    testAsyncSnapshotWithLog();
+    testAsyncSnapshotConcurrentWriter();
+
+    if (failures > 0) {
+        std::cerr << failures << " verificacoes falharam." << std::endl;
+        return 1;
+    }
+    std::cout << "Todos os testes do BTreeJournal passaram." << std::endl;
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include "BTree.h"
+#include "BTreeJournal.h"
+#include "BTreePersistence.h"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Testes de BTreePersistence: todos os formatos de gravação voltam à mesma
+// árvore, e arquivos truncados ou desconhecidos são recusados (nullptr).
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& description) {
+    if (!condition) {
+        std::cerr << "FALHOU: " << description << std::endl;
+        ++failures;
+    }
+}
+
+static const std::string FILE_NAME = "persistence_test.dat";
+static const std::string CUT_FILE = "persistence_cut_test.dat";
+
+static std::vector<int> allIds(BTree* tree) {
+    std::vector<int> ids = tree->searchRange(INT_MIN, INT_MAX);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+static std::vector<char> readBytes(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void writeBytes(const std::string& filename, const std::vector<char>& bytes, size_t length) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), length);
+}
+
+struct Variant {
+    const char* name;
+    bool compress;
+    int threads;
+};
+
+static const Variant VARIANTS[] = {
+    {"original", false, 1},
+    {"comprimido", true, 1},
+    {"subarvores", false, 4},
+    {"comprimido+subarvores", true, 4},
+    // Lotes de 3 subárvores: o último lote costuma ficar incompleto.
+    {"subarvores em lotes de 3", false, 3},
+};
+
+static void testRoundTrip(BTree& tree, const Variant& variant) {
+    std::string name = std::string(variant.name) + ": ";
+    BTreeSaveOptions options;
+    options.compressPostings = variant.compress;
+    options.threadCount = variant.threads;
+    BTreePersistence::saveToFile(&tree, FILE_NAME, options);
+    for (int threads : {1, 4}) {
+        BTree* loaded = BTreePersistence::loadFromFile(FILE_NAME, threads);
+        check(loaded != nullptr, name + "carrega");
+        if (!loaded) continue;
+        check(loaded->getMinDegree() == tree.getMinDegree(), name + "grau");
+        check(allIds(loaded) == allIds(&tree), name + "mesmos ids");
+        check(loaded->search(17) == tree.search(17), name + "busca pontual");
+        delete loaded;
+    }
+}
+
+static void testTruncated(const Variant& variant) {
+    // Cada prefixo do arquivo precisa ser recusado, nunca virar uma árvore
+    // vazia ou parcial. Os cortes cobrem cabeçalho, tabela e subárvores.
+    std::vector<char> bytes = readBytes(FILE_NAME);
+    size_t step = std::max<size_t>(1, bytes.size() / 200);
+    for (size_t length = 0; length < bytes.size(); length += step) {
+        writeBytes(CUT_FILE, bytes, length);
+        for (int threads : {1, 4}) {
+            BTree* loaded = BTreePersistence::loadFromFile(CUT_FILE, threads);
+            if (loaded) {
+                check(false, std::string(variant.name) + ": arquivo cortado em " + std::to_string(length) +
+                                 " de " + std::to_string(bytes.size()) + " bytes foi aceito");
+                delete loaded;
+                return;
+            }
+        }
+    }
+}
+
+static void testUnknownFlags() {
+    BTree tree(3);
+    tree.insert(1, 1);
+    BTreeSaveOptions options;
+    options.compressPostings = true;
+    BTreePersistence::saveToFile(&tree, FILE_NAME, options);
+    std::vector<char> bytes = readBytes(FILE_NAME);
+
+    // Cabeçalho: [magic][versão][flags][grau]. Uma flag nova (de uma versão
+    // futura) não pode ser ignorada em silêncio.
+    int flags = 0;
+    std::copy(bytes.begin() + 2 * sizeof(int), bytes.begin() + 3 * sizeof(int), (char*)&flags);
+    flags |= 1 << 10;
+    std::copy((char*)&flags, (char*)&flags + sizeof(int), bytes.begin() + 2 * sizeof(int));
+    writeBytes(CUT_FILE, bytes, bytes.size());
+    BTree* loaded = BTreePersistence::loadFromFile(CUT_FILE);
+    check(loaded == nullptr, "flag desconhecida recusada");
+    delete loaded;
+
+    int version = BTreePersistence::FORMAT_VERSION + 1;
+    bytes = readBytes(FILE_NAME);
+    std::copy((char*)&version, (char*)&version + sizeof(int), bytes.begin() + sizeof(int));
+    writeBytes(CUT_FILE, bytes, bytes.size());
+    loaded = BTreePersistence::loadFromFile(CUT_FILE);
+    check(loaded == nullptr, "versao futura recusada");
+    delete loaded;
+}
+
+// Grava "value" na posição "offset" de uma cópia do arquivo e tenta carregá-la.
+template <typename T>
+static bool loadsWithPatch(const std::string& filename, size_t offset, T value) {
+    std::vector<char> bytes = readBytes(filename);
+    std::copy((char*)&value, (char*)&value + sizeof(T), bytes.begin() + offset);
+    writeBytes(CUT_FILE, bytes, bytes.size());
+    BTree* loaded = BTreePersistence::loadFromFile(CUT_FILE);
+    delete loaded;
+    return loaded != nullptr;
+}
+
+static void testCorruptedCounts() {
+    // Uma contagem corrompida não pode virar uma alocação de gigabytes
+    // (std::bad_alloc escapando de loadFromFile): o arquivo é recusado.
+    BTree tree(3);
+    tree.insert(1, 10);
+    tree.insert(1, 11);
+
+    BTreePersistence::saveToFile(&tree, FILE_NAME);
+    // [grau][n][folha][achievementCount][size_t tamanho][ids]
+    size_t sizeOffset = sizeof(int) + sizeof(int) + sizeof(bool) + sizeof(int);
+    check(loadsWithPatch(FILE_NAME, sizeOffset, (size_t)2), "original: arquivo intacto carrega");
+    check(!loadsWithPatch(FILE_NAME, sizeOffset, (size_t)1 << 40), "original: tamanho gigante recusado");
+
+    BTreeSaveOptions options;
+    options.compressPostings = true;
+    BTreePersistence::saveToFile(&tree, FILE_NAME, options);
+    // [magic][versão][flags][grau][n][folha][achievementCount][count][length][bytes]
+    size_t countOffset = 4 * sizeof(int) + sizeof(int) + sizeof(bool) + sizeof(int);
+    check(loadsWithPatch(FILE_NAME, countOffset, (uint32_t)2), "comprimido: arquivo intacto carrega");
+    check(!loadsWithPatch(FILE_NAME, countOffset, (uint32_t)0xFFFFFFFF), "comprimido: count gigante recusado");
+    check(!loadsWithPatch(FILE_NAME, countOffset + sizeof(uint32_t), (uint32_t)0xFFFFFFF0),
+          "comprimido: length gigante recusado");
+}
+
+static void testCorruptedDegree() {
+    // Um grau corrompido não pode virar a alocação de nós de 2t-1 chaves
+    // (std::bad_alloc escapando de loadFromFile): o arquivo é recusado.
+    BTree tree(3);
+    tree.insert(1, 10);
+
+    BTreePersistence::saveToFile(&tree, FILE_NAME);
+    // [grau][n][folha][...]
+    check(loadsWithPatch(FILE_NAME, 0, (int)3), "original: grau intacto carrega");
+    for (int degree : {1 << 29, 1 << 20, 1, 0, -5}) {
+        check(!loadsWithPatch(FILE_NAME, 0, degree), "original: grau " + std::to_string(degree) + " recusado");
+    }
+
+    BTreeSaveOptions options;
+    options.compressPostings = true;
+    BTreePersistence::saveToFile(&tree, FILE_NAME, options);
+    // [magic][versão][flags][grau][...]
+    check(loadsWithPatch(FILE_NAME, 3 * sizeof(int), (int)3), "comprimido: grau intacto carrega");
+    check(!loadsWithPatch(FILE_NAME, 3 * sizeof(int), (int)(1 << 29)), "comprimido: grau gigante recusado");
+    check(!loadsWithPatch(FILE_NAME, 3 * sizeof(int), (int)1), "comprimido: grau 1 recusado");
+
+    // Graus grandes continuam aceitos quando o arquivo comporta um nó cheio.
+    BTree wide(BTreePersistence::MAX_UNCHECKED_DEGREE + 1);
+    for (int id = 0; id < 2 * wide.getMinDegree(); ++id) {
+        wide.insert(id, id);
+    }
+    BTreePersistence::saveToFile(&wide, FILE_NAME);
+    BTree* loaded = BTreePersistence::loadFromFile(FILE_NAME);
+    check(loaded != nullptr && allIds(loaded) == allIds(&wide), "grau grande com nós cheios carrega");
+    delete loaded;
+    std::remove(FILE_NAME.c_str());
+
+    // Sem snapshot, a árvore é recriada com o grau do cabeçalho do log.
+    {
+        BTreeJournal journal;
+        check(journal.open(FILE_NAME, 3), "log: open");
+        journal.logInsert(1, 10);
+        check(journal.flush(), "log: flush");
+    }
+    std::string log = BTreeJournal::pathFor(FILE_NAME);
+    loaded = BTreePersistence::loadFromFile(FILE_NAME);
+    check(loaded != nullptr && loaded->search(1) == std::vector<int>{10}, "log: grau intacto carrega");
+    delete loaded;
+    // Cabeçalho do log: [magic][grau].
+    std::vector<char> bytes = readBytes(log);
+    int degree = 1 << 29;
+    std::copy((char*)&degree, (char*)&degree + sizeof(int), bytes.begin() + sizeof(uint32_t));
+    writeBytes(log, bytes, bytes.size());
+    loaded = BTreePersistence::loadFromFile(FILE_NAME);
+    check(loaded == nullptr, "log: grau gigante recusado");
+    delete loaded;
+    std::remove(log.c_str());
+}
+
+int main() {
+    std::mt19937 rng(7);
+    BTree tree(4);
+    for (int id = 0; id < 20000; ++id) {
+        tree.insert((int)(rng() % 3000), id);
+    }
+    for (const Variant& variant : VARIANTS) {
+        testRoundTrip(tree, variant);
+        testTruncated(variant);
+    }
+
+    BTree empty(5);
+    BTreePersistence::saveToFile(&empty, FILE_NAME);
+    BTree* loaded = BTreePersistence::loadFromFile(FILE_NAME);
+    check(loaded != nullptr && loaded->getRoot() == nullptr && loaded->getMinDegree() == 5, "arvore vazia");
+    delete loaded;
+
+    testUnknownFlags();
+    testCorruptedCounts();
+    testCorruptedDegree();
+
+    std::remove(FILE_NAME.c_str());
+    std::remove(CUT_FILE.c_str());
+    if (failures > 0) {
+        std::cerr << failures << " verificacoes falharam." << std::endl;
+        return 1;
+    }
+    std::cout << "Todos os testes de BTreePersistence passaram." << std::endl;
+    return 0;
+}
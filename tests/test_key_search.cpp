@@ -0,0 +1,105 @@
+#include "KeySearch.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Testes do KeySearch: cada implementação (AVX2, SSE2, escalar) precisa
+// devolver o mesmo índice que std::lower_bound, inclusive nos tamanhos em
+// que a busca binária inicial passa a atuar (8 * LANES chaves).
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& description) {
+    if (!condition) {
+        std::cerr << "FALHOU: " << description << std::endl;
+        ++failures;
+    }
+}
+
+static const char* const IMPLEMENTATIONS[] = {"avx2", "sse2", "scalar"};
+
+// Chaves ordenadas com o preenchimento exigido por lowerBound.
+static std::vector<int32_t> padded(std::vector<int32_t> keys) {
+    std::sort(keys.begin(), keys.end());
+    keys.resize(KeySearch::paddedCount((int)keys.size()), INT32_MAX);
+    return keys;
+}
+
+static bool sameAsStd(const char* implementation, const std::vector<int32_t>& keys, int count, int target) {
+    int expected = (int)(std::lower_bound(keys.begin(), keys.begin() + count, target) - keys.begin());
+    return KeySearch::lowerBoundWith(implementation, keys.data(), count, target) == expected;
+}
+
+static void testImplementation(const char* implementation, std::mt19937& rng) {
+    std::string name = std::string(implementation) + ": ";
+    std::uniform_int_distribution<int32_t> narrow(-50, 50); // Muitas chaves repetidas.
+    std::uniform_int_distribution<int32_t> wide(INT32_MIN, INT32_MAX);
+
+    // De vazio até bem além do limite da busca binária.
+    for (int count = 0; count <= 24 * KeySearch::LANES + 3; ++count) {
+        for (int round = 0; round < 4; ++round) {
+            std::vector<int32_t> keys(count);
+            for (int32_t& key : keys) {
+                key = round % 2 == 0 ? narrow(rng) : wide(rng);
+            }
+            // Os extremos de int32 como chaves reais, ao lado do preenchimento.
+            if (round == 3 && count >= 2) {
+                keys[0] = INT32_MIN;
+                keys[1] = INT32_MAX;
+            }
+            keys = padded(keys);
+
+            std::vector<int32_t> targets = {INT32_MIN, INT32_MIN + 1, INT32_MAX - 1, INT32_MAX, 0};
+            for (int i = 0; i < count; ++i) {
+                targets.push_back(keys[i]);
+                if (keys[i] != INT32_MIN) targets.push_back(keys[i] - 1);
+                if (keys[i] != INT32_MAX) targets.push_back(keys[i] + 1);
+            }
+            for (int i = 0; i < 20; ++i) {
+                targets.push_back(round % 2 == 0 ? narrow(rng) : wide(rng));
+            }
+            for (int32_t target : targets) {
+                if (!sameAsStd(implementation, keys, count, target)) {
+                    check(false, name + "count=" + std::to_string(count) + " target=" + std::to_string(target));
+                    return;
+                }
+            }
+        }
+    }
+
+    // Todas as chaves iguais: o primeiro índice, nunca um do meio.
+    for (int count : {1, 7, 8, 9, 64, 65, 200}) {
+        std::vector<int32_t> keys = padded(std::vector<int32_t>(count, 5));
+        for (int32_t target : {4, 5, 6, INT32_MIN, INT32_MAX}) {
+            check(sameAsStd(implementation, keys, count, target),
+                  name + "chaves iguais count=" + std::to_string(count) + " target=" + std::to_string(target));
+        }
+    }
+}
+
+int main() {
+    std::mt19937 rng(2024);
+    bool testedSelected = false;
+    for (const char* implementation : IMPLEMENTATIONS) {
+        int32_t probe = 0;
+        if (KeySearch::lowerBoundWith(implementation, &probe, 0, 0) < 0) {
+            std::cout << "Implementacao " << implementation << " indisponivel neste processador." << std::endl;
+            continue;
+        }
+        testImplementation(implementation, rng);
+        if (std::string(implementation) == KeySearch::implementationName()) testedSelected = true;
+    }
+    check(testedSelected, "implementacao escolhida foi testada");
+    check(KeySearch::lowerBoundWith("inexistente", nullptr, 0, 0) == -1, "nome desconhecido recusado");
+
+    if (failures > 0) {
+        std::cerr << failures << " verificacoes falharam." << std::endl;
+        return 1;
+    }
+    std::cout << "Todos os testes do KeySearch passaram." << std::endl;
+    return 0;
+}
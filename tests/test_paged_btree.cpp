@@ -0,0 +1,251 @@
+#include "BTree.h"
+#include "BTreePersistence.h"
+#include "KeySearch.h"
+#include "PagedBTree.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Testes do formato paginado: buscas sobre o arquivo mapeado precisam
+// devolver o mesmo que a BTree em memória, e arquivos truncados ou com
+// ponteiros de filho corrompidos não podem travar nem ler fora do arquivo.
+// As páginas gravadas também precisam seguir o layout que KeySearch espera.
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& description) {
+    if (!condition) {
+        std::cerr << "FALHOU: " << description << std::endl;
+        ++failures;
+    }
+}
+
+static const std::string FILE_NAME = "paged_test.dat";
+static const std::string CUT_FILE = "paged_cut_test.dat";
+
+static std::vector<char> readBytes(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void writeBytes(const std::string& filename, const std::vector<char>& bytes, size_t length) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), length);
+}
+
+static std::vector<int> sorted(std::vector<int> ids) {
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Chaves repetidas num intervalo estreito, mais os extremos de int.
+static void fillTree(BTree& tree, std::mt19937& rng) {
+    std::uniform_int_distribution<int> keys(-500, 500);
+    int id = 0;
+    for (; id < 6000; ++id) {
+        tree.insert(keys(rng), id);
+    }
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        tree.insert(INT_MIN, id++);
+        tree.insert(INT_MAX, id++);
+        tree.insert(INT_MIN + 1, id++);
+        tree.insert(INT_MAX - 1, id++);
+    }
+}
+
+static void testSameAsBTree(int degree, std::mt19937& rng) {
+    std::string name = "t=" + std::to_string(degree) + ": ";
+    BTree tree(degree);
+    fillTree(tree, rng);
+    check(BTreePersistence::savePagedToFile(&tree, FILE_NAME), name + "salva");
+    std::unique_ptr<PagedBTree> paged(BTreePersistence::openPaged(FILE_NAME));
+    check(paged != nullptr, name + "abre");
+    if (!paged) return;
+    check(paged->getMinDegree() == degree, name + "grau");
+
+    std::vector<int> targets = {INT_MIN, INT_MIN + 1, INT_MIN + 2, INT_MAX - 2, INT_MAX - 1, INT_MAX};
+    for (int key = -510; key <= 510; ++key) {
+        targets.push_back(key);
+    }
+    for (int key : targets) {
+        if (paged->search(key) != tree.search(key)) {
+            check(false, name + "search(" + std::to_string(key) + ")");
+            return;
+        }
+    }
+
+    std::vector<std::pair<int, int>> ranges = {
+        {INT_MIN, INT_MAX}, {INT_MIN, INT_MIN}, {INT_MAX, INT_MAX}, {INT_MIN, -400},
+        {400, INT_MAX},     {-3, 3},            {7, 7},             {10, -10},
+    };
+    std::uniform_int_distribution<int> bounds(-520, 520);
+    for (int i = 0; i < 200; ++i) {
+        int a = bounds(rng);
+        int b = bounds(rng);
+        ranges.push_back({std::min(a, b), std::max(a, b)});
+    }
+    for (const std::pair<int, int>& range : ranges) {
+        if (sorted(paged->searchRange(range.first, range.second)) !=
+            sorted(tree.searchRange(range.first, range.second))) {
+            check(false, name + "searchRange(" + std::to_string(range.first) + ", " +
+                             std::to_string(range.second) + ")");
+            return;
+        }
+    }
+}
+
+static void testPageLayout(int degree, std::mt19937& rng, bool expectWideNode) {
+    // Confere no próprio arquivo o que KeySearch assume: chaves alinhadas a
+    // 32 bytes, em ordem, e as posições livres preenchidas com INT32_MAX.
+    std::string name = "layout t=" + std::to_string(degree) + ": ";
+    BTree tree(degree);
+    fillTree(tree, rng);
+    BTreePersistence::savePagedToFile(&tree, FILE_NAME);
+    std::vector<char> bytes = readBytes(FILE_NAME);
+    PagedFileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    PagedNodeLayout layout = PagedNodeLayout::forDegree(degree);
+    check(header.pageSize == layout.pageSize, name + "tamanho de pagina do cabecalho");
+    check(layout.pageSize % 64 == 0, name + "pagina multipla de 64");
+    check(layout.countsOffset % 32 == 0, name + "chaves alinhadas a 32 bytes");
+    check(layout.keySlots == KeySearch::paddedCount(2 * degree - 1), name + "posicoes de chave");
+    check(bytes.size() >= (header.nodeCount + 1) * header.pageSize, name + "todas as paginas no arquivo");
+    if (bytes.size() < (header.nodeCount + 1) * header.pageSize) return;
+
+    int widest = 0;
+    for (uint64_t page = 1; page <= header.nodeCount; ++page) {
+        const char* base = bytes.data() + page * header.pageSize;
+        check((page * header.pageSize + layout.countsOffset) % 32 == 0, name + "offset das chaves no disco");
+        PagedNodeHeader node;
+        std::memcpy(&node, base, sizeof(node));
+        std::vector<int32_t> counts(layout.keySlots);
+        std::memcpy(counts.data(), base + layout.countsOffset, counts.size() * sizeof(int32_t));
+        bool ok = node.keyCount >= 1 && node.keyCount <= 2 * degree - 1 &&
+                  std::is_sorted(counts.begin(), counts.begin() + node.keyCount) &&
+                  std::all_of(counts.begin() + node.keyCount, counts.end(),
+                              [](int32_t count) { return count == INT32_MAX; });
+        if (!ok) {
+            check(false, name + "pagina " + std::to_string(page) + " fora do formato");
+            return;
+        }
+        widest = std::max(widest, (int)node.keyCount);
+    }
+    if (expectWideNode) {
+        // Acima de 8 * LANES chaves a busca começa com a etapa binária.
+        check(widest > 8 * KeySearch::LANES, name + "algum no com mais de 64 chaves");
+    }
+}
+
+static void testEmpty() {
+    BTree tree(3);
+    check(BTreePersistence::savePagedToFile(&tree, FILE_NAME), "vazia: salva");
+    std::unique_ptr<PagedBTree> paged(BTreePersistence::openPaged(FILE_NAME));
+    check(paged != nullptr, "vazia: abre");
+    if (!paged) return;
+    check(paged->getNodeCount() == 0, "vazia: sem nos");
+    check(paged->search(0).empty() && paged->search(INT_MIN).empty(), "vazia: search");
+    check(paged->searchRange(INT_MIN, INT_MAX).empty(), "vazia: searchRange");
+}
+
+static void testTruncated(std::mt19937& rng) {
+    // Antes do fim das páginas o arquivo precisa ser recusado; depois disso
+    // só faltam playerIds, e as buscas não podem ler além do arquivo.
+    BTree tree(3);
+    fillTree(tree, rng);
+    BTreePersistence::savePagedToFile(&tree, FILE_NAME);
+    std::vector<char> bytes = readBytes(FILE_NAME);
+    PagedFileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    size_t step = std::max<size_t>(1, bytes.size() / 200);
+    for (size_t length = 0; length < bytes.size(); length += step) {
+        writeBytes(CUT_FILE, bytes, length);
+        std::unique_ptr<PagedBTree> paged(BTreePersistence::openPaged(CUT_FILE));
+        if (length < header.postingsOffset) {
+            if (paged) {
+                check(false, "arquivo paginado cortado em " + std::to_string(length) + " bytes foi aceito");
+                return;
+            }
+            continue;
+        }
+        if (paged) {
+            std::vector<int> all = paged->searchRange(INT_MIN, INT_MAX);
+            check(all.size() <= tree.searchRange(INT_MIN, INT_MAX).size(),
+                  "cortado em " + std::to_string(length) + ": ids a mais");
+        }
+    }
+}
+
+static void patchChild(std::vector<char>& bytes, uint64_t page, int index, uint64_t child) {
+    PagedFileHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    PagedNodeLayout layout = PagedNodeLayout::forDegree(header.minDegree);
+    size_t at = page + layout.childrenOffset + index * sizeof(uint64_t);
+    std::memcpy(bytes.data() + at, &child, sizeof(child));
+}
+
+static void testBackwardChild(std::mt19937& rng) {
+    // Um filho que aponta para a própria página ou para uma anterior formaria
+    // um ciclo; a busca tem que parar com o que já encontrou.
+    BTree tree(3);
+    fillTree(tree, rng);
+    BTreePersistence::savePagedToFile(&tree, FILE_NAME);
+    std::vector<char> original = readBytes(FILE_NAME);
+    PagedFileHeader header;
+    std::memcpy(&header, original.data(), sizeof(header));
+    PagedNodeHeader firstChild;
+    std::memcpy(&firstChild, original.data() + header.rootOffset + header.pageSize, sizeof(firstChild));
+    check(!firstChild.isLeaf, "ciclo: arvore com pelo menos tres niveis");
+    size_t total = tree.searchRange(INT_MIN, INT_MAX).size();
+
+    struct Patch {
+        const char* name;
+        uint64_t page;
+        uint64_t child;
+    };
+    const Patch patches[] = {
+        {"raiz aponta para si", header.rootOffset, header.rootOffset},
+        {"filho aponta para a raiz", header.rootOffset + header.pageSize, header.rootOffset},
+        {"filho aponta para si", header.rootOffset + header.pageSize, header.rootOffset + header.pageSize},
+        {"filho aponta para o cabecalho", header.rootOffset + header.pageSize, 0},
+    };
+    for (const Patch& patch : patches) {
+        std::vector<char> bytes = original;
+        patchChild(bytes, patch.page, 0, patch.child);
+        writeBytes(CUT_FILE, bytes, bytes.size());
+        std::unique_ptr<PagedBTree> paged(BTreePersistence::openPaged(CUT_FILE));
+        check(paged != nullptr, std::string(patch.name) + ": abre");
+        if (!paged) continue;
+        check(paged->search(INT_MIN).empty(), std::string(patch.name) + ": search para");
+        check(paged->searchRange(INT_MIN, INT_MAX).size() < total, std::string(patch.name) + ": searchRange para");
+    }
+}
+
+int main() {
+    std::mt19937 rng(11);
+    for (int degree : {2, 3, 4, 16, 40, 200}) {
+        testSameAsBTree(degree, rng);
+    }
+    testPageLayout(2, rng, false);
+    testPageLayout(40, rng, true);
+    testEmpty();
+    testTruncated(rng);
+    testBackwardChild(rng);
+
+    std::remove(FILE_NAME.c_str());
+    std::remove(CUT_FILE.c_str());
+    if (failures > 0) {
+        std::cerr << failures << " verificacoes falharam." << std::endl;
+        return 1;
+    }
+    std::cout << "Todos os testes de PagedBTree passaram." << std::endl;
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "PostingList.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// Testes da PostingList: codificação e decodificação sem perdas, busca e
+// interseção iguais às da biblioteca padrão sobre o vetor ordenado.
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& description) {
+    if (!condition) {
+        std::cerr << "FALHOU: " << description << std::endl;
+        ++failures;
+    }
+}
+
+static std::vector<int> sorted(std::vector<int> ids) {
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+static std::vector<int> randomIds(std::mt19937& rng, size_t count, int minValue, int maxValue) {
+    std::uniform_int_distribution<int> value(minValue, maxValue);
+    std::vector<int> ids(count);
+    for (int& id : ids) {
+        id = value(rng);
+    }
+    return ids;
+}
+
+// Mesma semântica de multiconjunto: cada repetição casa com uma da outra lista.
+static std::vector<int> expectedIntersection(const std::vector<int>& a, const std::vector<int>& b) {
+    std::vector<int> expected;
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    return expected;
+}
+
+static void testRoundTrip(const std::vector<int>& ids, const std::string& name) {
+    PostingList list = PostingList::encode(ids);
+    std::vector<int> expected = sorted(ids);
+    check(list.size() == ids.size(), name + ": size");
+    check(list.empty() == ids.empty(), name + ": empty");
+    check(list.decode() == expected, name + ": decode");
+
+    // Os bytes gravados devem reconstruir a mesma lista pelos dois caminhos.
+    const std::vector<uint8_t>& bytes = list.getBytes();
+    PostingList restored;
+    check(PostingList::fromBytes(bytes.data(), bytes.size(), list.size(), restored), name + ": fromBytes");
+    check(restored.decode() == expected, name + ": fromBytes decode");
+    std::vector<int> appended = {7};
+    check(PostingList::decodeBytes(bytes.data(), bytes.size(), list.size(), appended), name + ": decodeBytes");
+    check(appended.size() == expected.size() + 1 && appended[0] == 7 &&
+              std::equal(expected.begin(), expected.end(), appended.begin() + 1),
+          name + ": decodeBytes anexa ao vetor");
+
+    // Contagem errada ou bytes cortados precisam ser rejeitados.
+    PostingList wrong;
+    std::vector<int> ignored;
+    check(!PostingList::fromBytes(bytes.data(), bytes.size(), list.size() + 1, wrong), name + ": count maior");
+    check(!PostingList::decodeBytes(bytes.data(), bytes.size(), list.size() + 1, ignored),
+          name + ": decodeBytes count maior");
+    if (!bytes.empty()) {
+        check(!PostingList::decodeBytes(bytes.data(), bytes.size() - 1, list.size(), ignored),
+              name + ": bytes truncados");
+    }
+    check(!PostingList::decodeBytes(bytes.data(), bytes.size(), 0xFFFFFFFFu, ignored) && ignored.empty(),
+          name + ": count gigante recusado sem alocar");
+}
+
+static void testContains(std::mt19937& rng) {
+    std::vector<int> ids = randomIds(rng, 5000, -100000, 100000);
+    PostingList list = PostingList::encode(ids);
+    std::vector<int> expected = sorted(ids);
+    std::uniform_int_distribution<int> probe(-100010, 100010);
+    for (int i = 0; i < 20000; ++i) {
+        int value = probe(rng);
+        bool present = std::binary_search(expected.begin(), expected.end(), value);
+        if (list.contains(value) != present) {
+            check(false, "contains(" + std::to_string(value) + ")");
+            return;
+        }
+    }
+    for (int value : {expected.front(), expected.back(), INT_MIN, INT_MAX}) {
+        check(list.contains(value) == std::binary_search(expected.begin(), expected.end(), value),
+              "contains nos extremos");
+    }
+}
+
+static void testIntersect(std::mt19937& rng) {
+    // Tamanhos variados, inclusive listas muito desiguais (uso dos saltos).
+    const size_t sizes[] = {0, 1, 127, 128, 129, 1000, 50000};
+    for (size_t sizeA : sizes) {
+        for (size_t sizeB : sizes) {
+            // Faixa larga (poucas repetições) e estreita (sequências de ids
+            // iguais atravessando os blocos de 128).
+            for (int maxValue : {200000, 50}) {
+                std::vector<int> a = sorted(randomIds(rng, sizeA, 0, maxValue));
+                std::vector<int> b = sorted(randomIds(rng, sizeB, 0, maxValue));
+                check(PostingList::intersect(PostingList::encode(a), PostingList::encode(b)) == expectedIntersection(a, b),
+                      "intersect " + std::to_string(sizeA) + " x " + std::to_string(sizeB) +
+                          " max=" + std::to_string(maxValue));
+            }
+        }
+    }
+
+    // Repetições na fronteira de um bloco da lista maior.
+    std::vector<int> large(127, 0);
+    large.insert(large.end(), {5, 5, 6, 7});
+    std::vector<int> small = {5, 5};
+    check(PostingList::intersect(PostingList::encode(small), PostingList::encode(large)) == small,
+          "intersect com repeticoes cruzando blocos");
+    check(PostingList::intersect(PostingList::encode({5, 5, 5}), PostingList::encode(large)) == small,
+          "intersect limitado pelas repeticoes da lista maior");
+}
+
+int main() {
+    std::mt19937 rng(12345);
+
+    testRoundTrip({}, "vazia");
+    testRoundTrip({42}, "um id");
+    testRoundTrip({INT_MIN, -1, 0, 1, INT_MAX}, "extremos de int");
+    testRoundTrip({5, 5, 5, 3, 3}, "repeticoes");
+    for (size_t count : {127, 128, 129, 256, 1000, 100000}) {
+        testRoundTrip(randomIds(rng, count, 0, 1000000), "aleatoria " + std::to_string(count));
+        testRoundTrip(randomIds(rng, count, INT_MIN, INT_MAX), "espalhada " + std::to_string(count));
+    }
+    testContains(rng);
+    testIntersect(rng);
+
+    if (failures > 0) {
+        std::cerr << failures << " verificacoes falharam." << std::endl;
+        return 1;
+    }
+    std::cout << "Todos os testes da PostingList passaram." << std::endl;
+    return 0;
+}
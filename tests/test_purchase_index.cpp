@@ -0,0 +1,179 @@
+#include "PurchaseIndex.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// Testes do PurchaseIndex: os dois sentidos do CSR precisam ser iguais a
+// um índice ingênuo (std::map de std::set), para ids densos ou esparsos e
+// qualquer número de threads, inclusive depois de gravar e reabrir.
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& description) {
+    if (!condition) {
+        std::cerr << "FALHOU: " << description << std::endl;
+        ++failures;
+    }
+}
+
+static const std::string FILE_NAME = "purchase_index_test.dat";
+
+typedef std::map<int, std::set<int>> NaiveIndex;
+
+static std::vector<int> toVector(IdSpan span) {
+    return std::vector<int>(span.begin(), span.end());
+}
+
+static std::vector<int> toVector(const std::set<int>& ids) {
+    return std::vector<int>(ids.begin(), ids.end());
+}
+
+static bool sameAs(const PurchaseIndex& index, const NaiveIndex& byPlayer, const NaiveIndex& byGame,
+                   size_t purchaseCount) {
+    if (index.getPlayerCount() != byPlayer.size() || index.getGameCount() != byGame.size() ||
+        index.getPurchaseCount() != purchaseCount) {
+        return false;
+    }
+    for (const auto& entry : byPlayer) {
+        if (toVector(index.gamesOf(entry.first)) != toVector(entry.second)) return false;
+    }
+    for (const auto& entry : byGame) {
+        if (toVector(index.ownersOf(entry.first)) != toVector(entry.second)) return false;
+    }
+    return true;
+}
+
+static void testAgainstNaive(const std::vector<PurchasedGame>& purchases, const std::string& name) {
+    NaiveIndex byPlayer;
+    NaiveIndex byGame;
+    size_t purchaseCount = 0;
+    for (const PurchasedGame& purchase : purchases) {
+        byPlayer[purchase.getPlayerId()].insert(purchase.getGameId());
+        purchaseCount += byGame[purchase.getGameId()].insert(purchase.getPlayerId()).second ? 1 : 0;
+    }
+
+    for (int threads : {1, 3, 8}) {
+        std::string label = name + " threads=" + std::to_string(threads) + ": ";
+        PurchaseIndex index;
+        index.build(purchases, threads);
+        check(sameAs(index, byPlayer, byGame, purchaseCount), label + "igual ao índice ingênuo");
+        check(index.gamesOf(INT_MIN).empty() == (byPlayer.count(INT_MIN) == 0), label + "jogador inexistente");
+
+        if (threads == 1 && !byPlayer.empty()) {
+            // Interseções e posse comparadas nos primeiros pares de ids.
+            auto a = byPlayer.begin();
+            auto b = std::next(a, byPlayer.size() > 1 ? 1 : 0);
+            std::vector<int> expected;
+            std::set_intersection(a->second.begin(), a->second.end(), b->second.begin(), b->second.end(),
+                                  std::back_inserter(expected));
+            check(index.sharedGames(a->first, b->first) == expected, label + "sharedGames");
+            int game = *a->second.begin();
+            check(index.owns(a->first, game), label + "owns");
+            check(index.owns(a->first, INT_MAX) == (a->second.count(INT_MAX) > 0), label + "owns ausente");
+
+            check(index.saveToFile(FILE_NAME), label + "saveToFile");
+            PurchaseIndex opened;
+            check(opened.openFile(FILE_NAME), label + "openFile");
+            check(sameAs(opened, byPlayer, byGame, purchaseCount), label + "igual depois de reabrir");
+            std::remove(FILE_NAME.c_str());
+        }
+    }
+}
+
+static std::vector<PurchasedGame> randomPurchases(std::mt19937& rng, size_t count, int minId, int maxId) {
+    std::uniform_int_distribution<int> id(minId, maxId);
+    std::vector<PurchasedGame> purchases;
+    purchases.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        purchases.emplace_back(id(rng), id(rng));
+    }
+    return purchases;
+}
+
+static void testCorruptedOffsets() {
+    // Arquivo: [magic][versão][4 contagens de 64 bits] e depois, para os
+    // jogadores, [chaves com padding a 8][offsets][jogos]. openFile só confere
+    // o último offset, então um offset do meio corrompido tem que ser
+    // barrado na consulta.
+    std::vector<PurchasedGame> purchases;
+    for (int player = 0; player < 10; ++player) {
+        for (int game = 0; game <= player; ++game) {
+            purchases.emplace_back(player, game);
+        }
+    }
+    PurchaseIndex index;
+    index.build(purchases);
+    check(index.saveToFile(FILE_NAME), "offsets corrompidos: saveToFile");
+
+    std::ifstream in(FILE_NAME, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    const size_t headerBytes = 2 * sizeof(uint32_t) + 4 * sizeof(uint64_t);
+    uint64_t playerCount = 0;
+    std::memcpy(&playerCount, bytes.data() + sizeof(uint64_t), sizeof(uint64_t));
+    check(playerCount == 10, "offsets corrompidos: cabecalho");
+    size_t offsetsAt = headerBytes + (playerCount * sizeof(int) + 7) / 8 * 8;
+
+    const uint64_t corruptions[] = {UINT64_MAX, 1000000, 0};
+    for (uint64_t value : corruptions) {
+        std::vector<char> patched = bytes;
+        // Offset de fim do jogador 4 (= início do jogador 5).
+        std::memcpy(patched.data() + offsetsAt + 5 * sizeof(uint64_t), &value, sizeof(value));
+        std::ofstream out(FILE_NAME, std::ios::binary | std::ios::trunc);
+        out.write(patched.data(), patched.size());
+        out.close();
+
+        std::string label = "offset " + std::to_string(value) + ": ";
+        PurchaseIndex opened;
+        check(opened.openFile(FILE_NAME), label + "abre (so o ultimo offset e conferido)");
+        for (int player = 0; player < 10; ++player) {
+            IdSpan games = opened.gamesOf(player);
+            if (player == 4 || player == 5) {
+                // Linhas vizinhas ao offset: vazias ou dentro dos jogos.
+                check(games.count <= opened.getPurchaseCount(), label + "linha dentro do arquivo");
+            } else {
+                check(games.count == (size_t)player + 1, label + "outras linhas intactas");
+            }
+        }
+    }
+    std::remove(FILE_NAME.c_str());
+}
+
+int main() {
+    std::mt19937 rng(99);
+
+    testAgainstNaive({}, "vazio");
+    testAgainstNaive({PurchasedGame(5, 7)}, "uma compra");
+    testAgainstNaive({PurchasedGame(1, 2), PurchasedGame(1, 2), PurchasedGame(1, 1), PurchasedGame(0, 2)},
+                     "repetidas");
+    testAgainstNaive({PurchasedGame(INT_MIN, INT_MAX), PurchasedGame(INT_MAX, INT_MIN), PurchasedGame(0, 0)},
+                     "extremos de int");
+    // Ids densos (faixa menor que o número de compras) e esparsos, com
+    // mais de uma parte de CHUNK_SIZE compras.
+    testAgainstNaive(randomPurchases(rng, 150000, 0, 5000), "densos");
+    testAgainstNaive(randomPurchases(rng, 150000, -2000000000, 2000000000), "esparsos");
+    testAgainstNaive(randomPurchases(rng, 100000, 1000, 120000), "meio a meio");
+
+    testCorruptedOffsets();
+
+    PurchaseIndex index;
+    check(!index.openFile("purchase_index_inexistente.dat"), "arquivo inexistente");
+    check(index.getPlayerCount() == 0 && index.gamesOf(1).empty(), "vazio depois de falhar");
+
+    if (failures > 0) {
+        std::cerr << failures << " verificacoes falharam." << std::endl;
+        return 1;
+    }
+    std::cout << "Todos os testes do PurchaseIndex passaram." << std::endl;
+    return 0;
+}